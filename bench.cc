@@ -0,0 +1,836 @@
+/**
+ * @file bench.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Microbenchmarks of the scoreboard, built and run by "make bench"
+ *	Usage: ./scb_bench [size ...], board sizes default to 16 .. H_PLIMIT
+ *	Output is one tab separated line per benchmark and board size:
+ *	benchmark, size, ops, ns/op, ops/s, allocations/op
+ *	The stress benchmark runs reader threads against the writer and checks
+ *	every view they get, the run fails if a view is not consistent or if a
+ *	reader does not get the last version of the writer.
+ *	The ingest benchmark puts score changes into the queue from producer
+ *	threads, the run fails if the board differs from the changes applied
+ *	one by one.
+ *	The history benchmark loads a printed table with totals out of the
+ *	range of a change, the run fails if the board is not the printed one.
+ */
+
+#include "scoreboard.h"
+#include "interface.h"
+#include "name_check.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>		// clock_gettime
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+const unsigned BENCH_OPS = 100000;		///< Operations on one board
+const unsigned BENCH_MUT = 4096;		///< Most players added or removed
+const unsigned BENCH_ROWS = 1u << 20;	///< Rows printed or ranked in total
+const unsigned BENCH_READERS = 4;		///< Reader threads of the stress
+const unsigned BENCH_PRODUCERS = 4;		///< Producer threads of the ingest
+const char BENCH_HISTORY[] = "scb_bench_history.txt";	///< Printed table
+
+/// Number of heap allocations since the start
+static std::atomic<std::size_t> allocs{0};
+
+void *operator new(std::size_t size)
+{
+	allocs.fetch_add(1, std::memory_order_relaxed);
+	if (void *p = std::malloc(size ? size : 1))
+		return p;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+/**
+ * @brief Stream buffer discarding everything, print is measured without
+ *	the cost of the output
+ */
+class Null_buf : public std::streambuf
+{
+	protected:
+		int_type overflow(int_type c) override
+		{
+			return traits_type::not_eof(c);
+		}
+		std::streamsize xsputn(const char *, std::streamsize n) override
+		{
+			return n;
+		}
+};
+
+/**
+ * @brief Accumulates time and allocations of the measured sections, the
+ *	time is either wall time or processor time of the calling thread
+ */
+class Bench_timer
+{
+		bool cpu;					///< Processor time of the thread
+		double t0 = 0;
+		std::size_t a0 = 0;
+		double ns = 0;				///< Measured time
+		std::size_t n_allocs = 0;	///< Allocations in the measured time
+
+		double now() const
+		{
+			if (!cpu)
+				return std::chrono::duration<double, std::nano>(
+					std::chrono::steady_clock::now().time_since_epoch())
+						.count();
+
+			timespec ts;
+			clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+			return ts.tv_sec * 1e9 + ts.tv_nsec;
+		}
+	public:
+		explicit Bench_timer(bool thread_cpu = false): cpu{thread_cpu} {}
+
+		void start()
+		{
+			a0 = allocs.load(std::memory_order_relaxed);
+			t0 = now();
+		}
+		void stop()
+		{
+			double t1 = now();
+			n_allocs += allocs.load(std::memory_order_relaxed) - a0;
+			ns += t1 - t0;
+		}
+		void report(const char *name, unsigned size, unsigned long ops) const;
+};
+
+/**
+ * @brief Prints the result line of a benchmark
+ * @param name Name of the benchmark
+ * @param size Board size
+ * @param ops Number of measured operations
+ */
+void Bench_timer::report(const char *name, unsigned size,
+							unsigned long ops) const
+{
+	std::printf("%s\t%u\t%lu\t%.1f\t%.0f\t%.3f\n", name, size, ops, ns / ops,
+				ns ? ops * 1e9 / ns : 0.0, static_cast<double>(n_allocs) / ops);
+	std::fflush(stdout);
+}
+
+/**
+ * @brief Deterministic pseudo random numbers, same for every build
+ */
+class Bench_rand
+{
+		std::uint64_t state;
+	public:
+		explicit Bench_rand(std::uint64_t seed = 1): state{seed} {}
+		unsigned next(unsigned bound)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+			return (state >> 33) % bound;
+		}
+};
+
+/**
+ * @brief Benchmarks, each one measures only the operation, boards are
+ *	filled before the measurement
+ */
+class Scb_bench
+{
+		std::vector<std::string> names;		///< Unique player names
+		std::vector<int> scores;			///< Initial scores
+		std::vector<std::string> new_names;	///< Names for renaming
+		Null_buf null_buf;
+		std::ostream null_strm{&null_buf};
+	public:
+		Scb_bench();
+
+		void fill(Scoreboard &scb, unsigned from, unsigned to);
+
+		void add_player(unsigned size);
+		void rm_player(unsigned size);
+		void add_pscore_rank(unsigned size);
+		void add_pscore_name(unsigned size);
+		void add_pscore_id(unsigned size);
+		void rename_player(unsigned size);
+		void init_players(unsigned size);
+		void sort_scb(unsigned size);
+		void print(unsigned size);
+		void parser(unsigned size);
+		void name_check(unsigned size);
+		void find_players(unsigned size);
+		void undo_redo(unsigned size);
+		bool stress(unsigned size);
+		bool ingest(unsigned size);
+		bool history(unsigned size);
+	private:
+		void write_load(Scoreboard &scb, unsigned size);
+		static bool check_view(const Board_view &view, unsigned size);
+};
+
+/**
+ * @brief Prepares the names and scores of the players
+ */
+Scb_bench::Scb_bench()
+{
+	Bench_rand rnd;
+
+	names.reserve(H_PLIMIT);
+	scores.reserve(H_PLIMIT);
+	for (unsigned i = 0; i < H_PLIMIT; i++)
+	{
+		names.push_back("p" + std::to_string(i));
+		scores.push_back(static_cast<int>(rnd.next(2*MAX_SCORE + 1)) -
+							MAX_SCORE);
+	}
+
+	new_names.reserve(BENCH_OPS);
+	for (unsigned i = 0; i < BENCH_OPS; i++)
+		new_names.push_back("rn" + std::to_string(i));
+}
+
+/**
+ * @brief Adds players from the prepared ones
+ * @param scb Scoreboard
+ * @param from Index of the first added player
+ * @param to Index after the last added player
+ */
+void Scb_bench::fill(Scoreboard &scb, unsigned from, unsigned to)
+{
+	scb.set_max_players(H_PLIMIT);
+	for (unsigned i = from; i < to; i++)
+		scb.add_player(names[i], scores[i]);
+}
+
+/**
+ * @brief Adding players to a board which reaches the size
+ * @param size Board size
+ */
+void Scb_bench::add_player(unsigned size)
+{
+	Bench_timer t;
+	unsigned mut = std::min(size, BENCH_MUT);
+	unsigned rounds = (4 * BENCH_MUT + mut - 1) / mut;
+
+	for (unsigned r = 0; r < rounds; r++)
+	{
+		Scoreboard scb;
+		fill(scb, 0, size - mut);
+
+		t.start();
+		for (unsigned i = size - mut; i < size; i++)
+			scb.add_player(names[i], scores[i]);
+		t.stop();
+	}
+
+	t.report("add_player", size, static_cast<unsigned long>(rounds) * mut);
+}
+
+/**
+ * @brief Removing players by name from a board of the size
+ * @param size Board size
+ */
+void Scb_bench::rm_player(unsigned size)
+{
+	Bench_timer t;
+	unsigned mut = std::min(size, BENCH_MUT);
+	unsigned rounds = (4 * BENCH_MUT + mut - 1) / mut;
+
+	for (unsigned r = 0; r < rounds; r++)
+	{
+		Scoreboard scb;
+		fill(scb, 0, size);
+
+		t.start();
+		for (unsigned i = 0; i < mut; i++)
+			scb.rm_player(names[i]);
+		t.stop();
+	}
+
+	t.report("rm_player", size, static_cast<unsigned long>(rounds) * mut);
+}
+
+/**
+ * @brief Changing score of players identified by rank
+ * @param size Board size
+ */
+void Scb_bench::add_pscore_rank(unsigned size)
+{
+	Scoreboard scb;
+	Bench_rand rnd;
+	Bench_timer t;
+
+	fill(scb, 0, size);
+
+	t.start();
+	for (unsigned i = 0; i < BENCH_OPS; i++)
+		scb.add_pscore(rnd.next(size) + 1, i & 1 ? 1 : -1);
+	t.stop();
+
+	t.report("add_pscore_rank", size, BENCH_OPS);
+}
+
+/**
+ * @brief Changing score of players identified by name
+ * @param size Board size
+ */
+void Scb_bench::add_pscore_name(unsigned size)
+{
+	Scoreboard scb;
+	Bench_rand rnd;
+	Bench_timer t;
+
+	fill(scb, 0, size);
+
+	t.start();
+	for (unsigned i = 0; i < BENCH_OPS; i++)
+		scb.add_pscore(names[rnd.next(size)], i & 1 ? 1 : -1);
+	t.stop();
+
+	t.report("add_pscore_name", size, BENCH_OPS);
+}
+
+/**
+ * @brief Changing score of players identified by id, the players of a new
+ *	board have ids 1 .. size
+ * @param size Board size
+ */
+void Scb_bench::add_pscore_id(unsigned size)
+{
+	Scoreboard scb;
+	Bench_rand rnd;
+	Bench_timer t;
+
+	fill(scb, 0, size);
+
+	t.start();
+	for (unsigned i = 0; i < BENCH_OPS; i++)
+		scb.add_pscore(Pl_id{rnd.next(size) + 1}, i & 1 ? 1 : -1);
+	t.stop();
+
+	t.report("add_pscore_id", size, BENCH_OPS);
+}
+
+/**
+ * @brief Renaming players identified by rank
+ * @param size Board size
+ */
+void Scb_bench::rename_player(unsigned size)
+{
+	Scoreboard scb;
+	Bench_rand rnd;
+	Bench_timer t;
+
+	fill(scb, 0, size);
+
+	t.start();
+	for (unsigned i = 0; i < BENCH_OPS; i++)
+		scb.rename_player(rnd.next(size) + 1, new_names[i]);
+	t.stop();
+
+	t.report("rename_player", size, BENCH_OPS);
+}
+
+/**
+ * @brief Creating a board of default players
+ * @param size Board size
+ */
+void Scb_bench::init_players(unsigned size)
+{
+	Bench_timer t;
+	unsigned reps = std::max(4u, BENCH_ROWS / 4 / size);
+
+	for (unsigned r = 0; r < reps; r++)
+	{
+		Scoreboard scb;
+		scb.set_max_players(H_PLIMIT);
+
+		t.start();
+		scb.init_players(size);
+		t.stop();
+	}
+
+	t.report("init_players", size, reps);
+}
+
+/**
+ * @brief Rebuilding the whole ranking
+ * @param size Board size
+ */
+void Scb_bench::sort_scb(unsigned size)
+{
+	Scoreboard scb;
+	Bench_timer t;
+	unsigned reps = std::max(4u, BENCH_ROWS / size);
+
+	fill(scb, 0, size);
+
+	t.start();
+	for (unsigned r = 0; r < reps; r++)
+		scb.sort_scb();
+	t.stop();
+
+	t.report("sort_scb", size, reps);
+}
+
+/**
+ * @brief Printing the whole table to a stream discarding the output
+ * @param size Board size
+ */
+void Scb_bench::print(unsigned size)
+{
+	Scoreboard scb;
+	Bench_timer t;
+	unsigned reps = std::max(4u, BENCH_ROWS / size);
+
+	fill(scb, 0, size);
+	scb.print(null_strm);		// layout of the renderer is built
+
+	t.start();
+	for (unsigned r = 0; r < reps; r++)
+		scb.print(null_strm);
+	t.stop();
+
+	t.report("print", size, reps);
+}
+
+/**
+ * @brief Parsing and executing command lines, the scoreboard of the
+ *	interface is used
+ * @param size Board size
+ */
+void Scb_bench::parser(unsigned size)
+{
+	Bench_rand rnd;
+	Bench_timer t;
+	std::vector<std::string> lines;
+
+	exec_cmd("player remove all");
+	exec_cmd("set plimit 65535");
+	for (unsigned i = 0; i < size; i++)
+		exec_cmd("player add " + names[i] + " " + std::to_string(scores[i]));
+
+	lines.reserve(BENCH_OPS);
+	for (unsigned i = 0; i < BENCH_OPS; i++)
+	{
+		std::string rank = std::to_string(rnd.next(size) + 1);
+		const std::string &name = names[rnd.next(size)];
+		switch (i % 4)
+		{
+			case 0: lines.push_back("score add " + rank + " 2"); break;
+			case 1: lines.push_back("win " + name); break;
+			case 2: lines.push_back("loss " + rank); break;
+			default: lines.push_back("  score  add " + name + " -2"); break;
+		}
+	}
+
+	t.start();
+	for (const std::string &line : lines)
+		exec_cmd(line);
+	t.stop();
+
+	t.report("parser", size, BENCH_OPS);
+}
+
+/**
+ * @brief Validating the names of the players, all in one call, as the
+ *	roster import does
+ * @param size Number of the names
+ */
+void Scb_bench::name_check(unsigned size)
+{
+	std::vector<std::string_view> views(names.begin(), names.begin() + size);
+	std::unique_ptr<bool[]> ok(new bool[size]);
+	unsigned reps = std::max(1u, BENCH_OPS / size);
+	Bench_timer t;
+	std::size_t valid = 0;
+
+	t.start();
+	for (unsigned r = 0; r < reps; r++)
+		valid += valid_names(views.data(), size, ok.get());
+	t.stop();
+
+	t.report("name_check", size, static_cast<unsigned long>(reps) * size);
+	if (valid != static_cast<std::size_t>(reps) * size)
+		std::fprintf(stderr, "Valid names rejected\n");
+}
+
+/**
+ * @brief Searching players by the start of the name of a random player,
+ *	the first FIND_SHOWN are listed, and by a pattern
+ * @param size Board size
+ */
+void Scb_bench::find_players(unsigned size)
+{
+	Scoreboard scb;
+	Bench_rand rnd;
+	Bench_timer t;
+
+	fill(scb, 0, size);
+
+	std::string pattern;
+	t.start();
+	for (unsigned i = 0; i < BENCH_OPS; i++)
+	{
+		std::string_view name = names[rnd.next(size)];
+		if (i & 1)
+			scb.find_players(name.substr(0, 3));
+		else
+		{
+			pattern.assign("p?").append(name.substr(2)).push_back('%');
+			scb.find_players(pattern);
+		}
+	}
+	t.stop();
+
+	t.report("find_players", size, BENCH_OPS);
+}
+
+/**
+ * @brief Undoing and redoing score changes by id, all the kept steps at
+ *	once, each step is one change
+ * @param size Board size
+ */
+void Scb_bench::undo_redo(unsigned size)
+{
+	Scoreboard scb;
+	Bench_rand rnd;
+	Bench_timer t;
+
+	fill(scb, 0, size);
+	for (unsigned i = 0; i < UNDO_DEPTH; i++)
+		scb.add_pscore(Pl_id{rnd.next(size) + 1}, i & 1 ? 1 : -1);
+
+	const unsigned rounds = BENCH_OPS / (2 * UNDO_DEPTH);
+	t.start();
+	for (unsigned i = 0; i < rounds; i++)
+	{
+		scb.undo(UNDO_DEPTH);
+		scb.redo(UNDO_DEPTH);
+	}
+	t.stop();
+
+	t.report("undo_redo", size, 2ul * rounds * UNDO_DEPTH);
+}
+
+/**
+ * @brief Mutations of the stress benchmark, mostly score changes by id,
+ *	renames, removals and additions, the board keeps its size
+ * @param scb Scoreboard filled with size players, ids 1 .. size
+ * @param size Board size
+ */
+void Scb_bench::write_load(Scoreboard &scb, unsigned size)
+{
+	Bench_rand rnd;
+	std::vector<Pl_id> ids;
+
+	for (unsigned i = 0; i < size; i++)
+		ids.push_back(Pl_id{i + 1});
+
+	for (unsigned i = 0; i < BENCH_OPS; i++)
+	{
+		unsigned who = rnd.next(size);
+		switch (i % 256)
+		{
+			case 0:
+				scb.rename_player(ids[who], new_names[i]);
+				break;
+			case 128:
+				scb.rm_player(ids[who]);
+				scb.add_player(new_names[i], scores[who]);
+				ids[who] = scb.get_id(new_names[i]);
+				break;
+			default:
+				scb.add_pscore(ids[who], i & 1 ? 1 : -1);
+		}
+	}
+}
+
+/**
+ * @brief Checks that a view is a consistent ranking
+ * @param view View of the board
+ * @param size Board size, one player can be missing
+ * @return True if the view is consistent
+ */
+bool Scb_bench::check_view(const Board_view &view, unsigned size)
+{
+	if (view.size() != size && view.size() + 1 != size)
+		return false;
+
+	bool ok = true;
+	std::size_t rows = 0;
+	const View_row *prev = nullptr;
+	view.for_each([&](int, const View_row &row)
+	{
+		if (!row.len || !row.id.num || (prev && !Rank_index::higher(
+				prev->score, prev->get_name(), row.score, row.get_name())))
+			ok = false;
+		prev = &row;
+		rows++;
+	});
+
+	return ok && rows == view.size();
+}
+
+/**
+ * @brief Writer changing the board while reader threads take views of it
+ *	and print them, measured first without the readers, wall time of the
+ *	writer includes the readers if they share its processor, so also its
+ *	processor time is reported, every reader has to see the last version
+ *	of the writer after it ends
+ * @param size Board size
+ * @return False if a reader got an inconsistent view or not the last one
+ */
+bool Scb_bench::stress(unsigned size)
+{
+	{
+		Scoreboard scb;
+		Bench_timer t;
+
+		fill(scb, 0, size);
+		t.start();
+		write_load(scb, size);
+		t.stop();
+		t.report("stress_alone", size, BENCH_OPS);
+	}
+
+	Scoreboard scb;
+	Bench_timer t, tc(true), tv;
+	std::atomic<bool> bad{false};
+	std::atomic<std::uint64_t> final{~static_cast<std::uint64_t>(0)};
+	std::atomic<unsigned> caught{0};
+	std::atomic<unsigned long> views{0};
+	std::vector<std::thread> readers;
+
+	fill(scb, 0, size);
+	tv.start();
+	for (unsigned r = 0; r < BENCH_READERS; r++)
+		readers.emplace_back([&]()
+		{
+			Null_buf quiet;
+			std::ostream strm(&quiet);
+			Table_render render;
+			std::uint64_t last = 0;
+			auto until = std::chrono::steady_clock::time_point::max();
+
+			while (std::chrono::steady_clock::now() < until)
+			{
+				std::shared_ptr<const Board_view> v = scb.view();
+				if (v->version < last || !check_view(*v, size))
+					bad.store(true);
+				last = v->version;
+				v->print(strm, render);
+				views.fetch_add(1, std::memory_order_relaxed);
+
+				// writer ended, its last version has to come soon
+				if (v->version == final.load())
+				{
+					caught.fetch_add(1);
+					break;
+				}
+				if (final.load() != ~static_cast<std::uint64_t>(0) &&
+					until == std::chrono::steady_clock::time_point::max())
+					until = std::chrono::steady_clock::now() +
+							std::chrono::seconds(1);
+			}
+		});
+
+	t.start();
+	tc.start();
+	write_load(scb, size);
+	tc.stop();
+	t.stop();
+
+	final.store(scb.get_version());
+	for (std::thread &th : readers)
+		th.join();
+	tv.stop();
+
+	t.report("stress_writer", size, BENCH_OPS);
+	tc.report("stress_writer_cpu", size, BENCH_OPS);
+	tv.report("stress_views", size, std::max(1ul, views.load()));
+	if (bad.load())
+		std::fprintf(stderr, "Inconsistent view of a board of %u players\n",
+						size);
+	if (caught.load() != BENCH_READERS)
+		std::fprintf(stderr, "Last version of a board of %u players not "
+						"seen by a reader\n", size);
+
+	return !bad.load() && caught.load() == BENCH_READERS;
+}
+
+/**
+ * @brief Score changes by id applied one by one, and queued by producer
+ *	threads and applied in batches by the applier, the time of the queue
+ *	is from the first push until all the changes are applied
+ * @param size Board size
+ * @return False if the boards differ at the end
+ */
+bool Scb_bench::ingest(unsigned size)
+{
+	Bench_rand rnd;
+	std::vector<Score_event> evs(BENCH_OPS);
+	for (unsigned i = 0; i < BENCH_OPS; i++)
+	{
+		evs[i].id = Pl_id{rnd.next(size) + 1};
+		evs[i].num = i & 1 ? 1 : -1;
+		evs[i].len = 0;
+	}
+
+	Scoreboard direct;
+	Bench_timer td;
+
+	fill(direct, 0, size);
+	td.start();
+	for (const Score_event &ev : evs)
+		direct.add_pscore(ev.id, ev.num);
+	td.stop();
+	td.report("ingest_direct", size, BENCH_OPS);
+
+	Scoreboard queued;
+	Ingest ing(queued);
+	Bench_timer tq;
+	std::vector<std::thread> producers;
+
+	fill(queued, 0, size);
+	ing.start(INGEST_SIZE, IF_BLOCK);
+	tq.start();
+	for (unsigned p = 0; p < BENCH_PRODUCERS; p++)
+		producers.emplace_back([&, p]()
+		{
+			for (unsigned i = p; i < BENCH_OPS; i += BENCH_PRODUCERS)
+				ing.submit(evs[i]);
+		});
+	for (std::thread &th : producers)
+		th.join();
+	ing.stop();
+	tq.stop();
+	tq.report("ingest_queue", size, BENCH_OPS);
+
+	std::vector<std::pair<std::uint32_t, int>> rows[2];
+	Scoreboard *boards[2] = {&direct, &queued};
+	for (unsigned i = 0; i < 2; i++)
+		boards[i]->view()->for_each([&](int, const View_row &row)
+		{
+			rows[i].emplace_back(row.id.num, row.score);
+		});
+	bool same = rows[0] == rows[1];
+
+	if (!same)
+		std::fprintf(stderr, "Queued changes differ on a board of %u "
+						"players\n", size);
+	return same;
+}
+
+/**
+ * @brief Loading of a table printed by the board, half of the players
+ *	have totals above MAX_SCORE and half below MIN_SCORE
+ * @param size Board size
+ * @return False if the loaded board differs from the printed one
+ */
+bool Scb_bench::history(unsigned size)
+{
+	Scoreboard printed;
+	fill(printed, 0, size);
+	for (unsigned i = 0; i < size; i++)
+		for (int k = 0; k < 2; k++)
+			printed.add_pscore(names[i], i & 1 ? MAX_SCORE : MIN_SCORE);
+	{
+		std::ofstream file(BENCH_HISTORY);
+		printed.print(file);
+	}
+
+	Scoreboard loaded;
+	Bench_timer t;
+
+	loaded.set_max_players(H_PLIMIT);
+	t.start();
+	bool read = loaded.load_history(BENCH_HISTORY);
+	t.stop();
+	t.report("load_history", size, size);
+	std::remove(BENCH_HISTORY);
+
+	std::vector<std::pair<std::string, int>> rows[2];
+	Scoreboard *boards[2] = {&printed, &loaded};
+	for (unsigned i = 0; i < 2; i++)
+		boards[i]->view()->for_each([&](int, const View_row &row)
+		{
+			rows[i].emplace_back(row.get_name(), row.score);
+		});
+	bool same = read && rows[0] == rows[1];
+
+	if (!same)
+		std::fprintf(stderr, "Printed table of %u players not loaded back\n",
+						size);
+	return same;
+}
+
+/**
+ * @brief Runs all the benchmarks for each board size
+ */
+int main(int argc, char *argv[])
+{
+	std::vector<unsigned> sizes;
+	for (int i = 1; i < argc; i++)
+	{
+		long size = std::strtol(argv[i], nullptr, 10);
+		if (size < 1 || size > H_PLIMIT)
+		{
+			std::fprintf(stderr, "Board size must be 1 .. %d\n", H_PLIMIT);
+			return EXIT_FAILURE;
+		}
+		sizes.push_back(size);
+	}
+
+	if (sizes.empty())
+		sizes = {16, 256, 4096, H_PLIMIT};
+
+	Scb_bench bench;
+	Null_buf quiet;
+	// messages of the scoreboard, not results
+	std::streambuf *out = std::cout.rdbuf(&quiet);
+
+	std::printf("# benchmark\tsize\tops\tns_per_op\tops_per_s\t"
+				"allocs_per_op\n");
+	bool ok = true;
+	for (unsigned size : sizes)
+	{
+		bench.add_player(size);
+		bench.rm_player(size);
+		bench.add_pscore_rank(size);
+		bench.add_pscore_name(size);
+		bench.add_pscore_id(size);
+		bench.rename_player(size);
+		bench.init_players(size);
+		bench.sort_scb(size);
+		bench.print(size);
+		bench.parser(size);
+		bench.name_check(size);
+		bench.find_players(size);
+		bench.undo_redo(size);
+		ok = bench.stress(size) && ok;
+		ok = bench.ingest(size) && ok;
+		ok = bench.history(size) && ok;
+	}
+
+	std::cout.rdbuf(out);		// quiet does not outlive main
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,398 @@
+/**
+ * @file board_view.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the immutable views of the board and of their
+ *	draft
+ */
+
+#include "board_view.h"
+#include "scoreboard.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+
+/**
+ * @brief Tells if only the writer holds an object, readers which held it
+ *	are done with it, so the writer can reuse it
+ * @param ptr Object shared with the readers
+ * @return True if ptr is the only owner
+ */
+template<typename T>
+static inline bool unshared(const std::shared_ptr<T> &ptr)
+{
+	if (ptr.use_count() != 1)
+		return false;
+
+	// pairs with the release of the last reader
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return true;
+}
+
+/**
+ * @brief Renders the score table of the view, same as Scoreboard::print
+ * @param render Renderer owned by the calling thread, holds the table
+ */
+void Board_view::render(Table_render &render) const
+{
+	debug_info();
+	Stat_scope st(STAT_RENDER);
+
+	std::size_t limit = show_max == HGHT_LIMIT ? count :
+						std::min<std::size_t>(show_max, count);
+
+	render.begin();
+	for_each([&](int rank, const View_row &row)
+	{
+		render.row(rank, row.get_name(), row.score);
+	}, limit);
+	scb_stats.count(STAT_ROWS, limit);
+}
+
+/**
+ * @brief Prints the score table of the view
+ * @param strm Output stream
+ * @param render Renderer owned by the calling thread
+ */
+void Board_view::print(std::ostream &strm, Table_render &render) const
+{
+	this->render(render);
+	strm.write(render.data(), render.size());
+	strm.flush();
+}
+
+/**
+ * @brief Exports the view as a binary snapshot, see snapshot.h
+ * @param path Path of the snapshot file
+ * @return True on success
+ */
+bool Board_view::save(const std::string &path) const
+{
+	debug_info();
+
+	Snap_writer snap;
+	snap.begin(count, show_max, max_players, 0, next_id.num);
+	for_each([&](int, const View_row &row)
+	{
+		snap.add(row.get_name(), row.score, row.id.num);
+	});
+
+	return snap.write(path);
+}
+
+/**
+ * @brief Removes all the rows, after the ranking was built again
+ */
+void View_draft::clear()
+{
+	for (Chunk *chunk : chunks)
+		retire(chunk);
+
+	chunks.clear();
+	parts.clear();
+	sums_stale = true;
+	count = 0;
+}
+
+/**
+ * @brief Appends a player, in the order of ranking
+ * @param name Player name
+ * @param score Player score
+ * @param id Player id
+ */
+void View_draft::push_back(std::string_view name, int score, Pl_id id)
+{
+	if (chunks.empty() || parts.back().size == VIEW_CHUNK)
+	{
+		chunks.push_back(take());
+		parts.push_back(View_part{chunks.back()->rows, 0});
+	}
+
+	View_row *rows = own(chunks.size() - 1);
+	set_row(rows[parts.back().size++], name, score, id);
+	sums_stale = true;					// rows are appended in bulk
+	count++;
+}
+
+/**
+ * @brief Inserts a player, a full chunk is split in halves first
+ * @param pos Position of the player in the ranking, from 0
+ * @param name Player name
+ * @param score Player score
+ * @param id Player id
+ */
+void View_draft::insert(std::size_t pos, std::string_view name, int score,
+						Pl_id id)
+{
+	if (chunks.empty())
+	{
+		chunks.push_back(take());
+		parts.push_back(View_part{chunks.back()->rows, 0});
+		sums_stale = true;
+	}
+
+	std::size_t c = locate(pos);
+	View_row *rows = own(c);
+	if (parts[c].size == VIEW_CHUNK)
+	{
+		const unsigned half = VIEW_CHUNK / 2;
+		Chunk *next = take();
+		std::memcpy(next->rows, rows + half,
+					(VIEW_CHUNK - half) * sizeof(View_row));
+		chunks.insert(chunks.begin() + c + 1, next);
+		parts.insert(parts.begin() + c + 1,
+					View_part{next->rows, VIEW_CHUNK - half});
+		parts[c].size = half;
+		sums_stale = true;
+
+		if (pos > half)
+		{
+			c++;
+			pos -= half;
+			rows = next->rows;
+		}
+	}
+
+	std::memmove(rows + pos + 1, rows + pos,
+				(parts[c].size - pos) * sizeof(View_row));
+	set_row(rows[pos], name, score, id);
+	resize(c, 1);
+	count++;
+}
+
+/**
+ * @brief Removes a player, an emptied chunk is dropped, a small one is
+ *	merged with its neighbour
+ * @param pos Position of the player in the ranking, from 0
+ */
+void View_draft::erase(std::size_t pos)
+{
+	std::size_t c = locate(pos);
+	View_row *rows = own(c);
+	std::memmove(rows + pos, rows + pos + 1,
+				(parts[c].size - pos - 1) * sizeof(View_row));
+	resize(c, -1);
+	count--;
+
+	std::size_t gone;					// chunk dropped from the draft
+	if (!parts[c].size)
+		gone = c;
+	else if (c + 1 < chunks.size() &&
+			parts[c].size + parts[c+1].size <= VIEW_CHUNK / 2)
+	{
+		std::memcpy(rows + parts[c].size, parts[c+1].rows,
+					parts[c+1].size * sizeof(View_row));
+		parts[c].size += parts[c+1].size;
+		gone = c + 1;
+	}
+	else if (c > 0 && parts[c-1].size + parts[c].size <= VIEW_CHUNK / 2)
+	{
+		View_row *prev = own(c - 1);
+		std::memcpy(prev + parts[c-1].size, rows,
+					parts[c].size * sizeof(View_row));
+		parts[c-1].size += parts[c].size;
+		gone = c;
+	}
+	else
+		return;
+
+	retire(chunks[gone]);
+	chunks.erase(chunks.begin() + gone);
+	parts.erase(parts.begin() + gone);
+	sums_stale = true;
+}
+
+/**
+ * @brief Makes a view of the draft, the chunks of the draft are not
+ *	changed any more while the view is held
+ * @param version Version of the board
+ * @param show_max How many players are shown
+ * @param max_players Player limit
+ * @param next_id Id of the next new player
+ * @return View of the board
+ */
+std::shared_ptr<const Board_view> View_draft::publish(std::uint64_t version,
+								int show_max, unsigned max_players,
+								Pl_id next_id)
+{
+	reclaim();
+
+	std::shared_ptr<Board_view> view;
+	for (auto &[held, made] : views)
+		if (unshared(held))
+		{
+			view = held;
+			made = draft;
+			break;
+		}
+
+	if (!view)
+	{
+		view = std::make_shared<Board_view>();
+		view->chunks = pool;
+		views.emplace_back(view, draft);
+	}
+
+	view->parts = parts;		// keeps the capacity of a reused view
+	view->count = count;
+	view->version = version;
+	view->show_max = show_max;
+	view->max_players = max_players;
+	view->next_id = next_id;
+
+	draft++;				// chunks of the view are frozen
+	return view;
+}
+
+/**
+ * @brief Finds the chunk of a position, the tree of the sizes is built
+ *	again after chunks were added or removed
+ * @param pos Position in the ranking, the count to append, changed to the
+ *	position in the chunk
+ * @return Index of the chunk
+ */
+std::size_t View_draft::locate(std::size_t &pos)
+{
+	std::size_t n = parts.size();
+	if (sums_stale)
+	{
+		sums.assign(n + 1, 0);
+		for (std::size_t i = 1; i <= n; i++)
+		{
+			sums[i] += parts[i-1].size;
+			std::size_t up = i + (i & -i);
+			if (up <= n)
+				sums[up] += sums[i];
+		}
+		sums_stale = false;
+	}
+
+	std::size_t step = 1;
+	while (step * 2 <= n)
+		step *= 2;
+
+	std::size_t c = 0;
+	for (; step; step /= 2)
+		if (c + step <= n && sums[c+step] <= pos)
+		{
+			c += step;
+			pos -= sums[c];
+		}
+
+	if (c == n)							// appended to the last chunk
+	{
+		c--;
+		pos += parts[c].size;
+	}
+
+	return c;
+}
+
+/**
+ * @brief Changes the size of a chunk
+ * @param c Index of the chunk
+ * @param diff Rows added, negative for removed
+ */
+void View_draft::resize(std::size_t c, int diff)
+{
+	parts[c].size += diff;
+	if (sums_stale)
+		return;
+
+	for (std::size_t i = c + 1; i < sums.size(); i += i & -i)
+		sums[i] += diff;
+}
+
+/**
+ * @brief Gives rows of a chunk which can be changed, a chunk of a view is
+ *	copied to a new one first
+ * @param c Index of the chunk
+ * @return Rows of the chunk
+ */
+View_row *View_draft::own(std::size_t c)
+{
+	if (chunks[c]->made == draft)
+		return chunks[c]->rows;
+
+	Chunk *copy = take();
+	std::memcpy(copy->rows, chunks[c]->rows, parts[c].size * sizeof(View_row));
+	retire(chunks[c]);
+	chunks[c] = copy;
+	parts[c].rows = copy->rows;
+	return copy->rows;
+}
+
+/**
+ * @brief Takes a chunk of no view, or makes a new one
+ * @return Chunk of the draft
+ */
+View_draft::Chunk *View_draft::take()
+{
+	Chunk *chunk;
+	if (free_c.empty())
+	{
+		pool->all.push_back(std::make_unique<Chunk>());
+		chunk = pool->all.back().get();
+	}
+	else
+	{
+		chunk = free_c.back();
+		free_c.pop_back();
+	}
+
+	chunk->made = draft;
+	return chunk;
+}
+
+/**
+ * @brief Drops a chunk from the draft, a chunk of a view is kept until no
+ *	reader holds a view with it
+ * @param chunk Chunk of the draft
+ */
+void View_draft::retire(Chunk *chunk)
+{
+	if (chunk->made == draft)
+		free_c.push_back(chunk);
+	else
+		retired.emplace_back(chunk, draft);
+}
+
+/**
+ * @brief Frees the retired chunks which are in no held view, views older
+ *	than the oldest held one are not held either
+ */
+void View_draft::reclaim()
+{
+	std::uint64_t oldest = draft;
+	for (auto &[held, made] : views)
+		if (!unshared(held))
+			oldest = std::min(oldest, made);
+
+	auto kept = std::remove_if(retired.begin(), retired.end(),
+					[&](const std::pair<Chunk *, std::uint64_t> &r)
+					{
+						if (r.second > oldest)
+							return false;
+						free_c.push_back(r.first);
+						return true;
+					});
+	retired.erase(kept, retired.end());
+}
+
+/**
+ * @brief Fills a row
+ * @param row Row of the draft
+ * @param name Player name
+ * @param score Player score
+ * @param id Player id
+ */
+void View_draft::set_row(View_row &row, std::string_view name, int score,
+						Pl_id id)
+{
+	row.len = std::min<std::size_t>(name.size(), SLOT_NAME);
+	std::memcpy(row.name, name.data(), row.len);
+	row.score = score;
+	row.id = id;
+}
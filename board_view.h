@@ -0,0 +1,160 @@
+/**
+ * @file board_view.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Immutable copy of the ranking for readers on other threads
+ *	The writer keeps a draft of the ranking in chunks of rows and applies
+ *	every change of the ranking to it, a view published at the end of a
+ *	mutation refers to the chunks of the draft. A chunk which is in a
+ *	published view is never changed, the draft copies it first, so a
+ *	change costs the copy of one chunk and of the list of the chunks, not
+ *	a copy of the board. Readers only load the last view, they never wait
+ *	for the writer and the writer never waits for them. Chunks and views
+ *	no reader holds any more are reused by the writer.
+ */
+
+#ifndef BOARD_VIEW_H
+#define BOARD_VIEW_H
+
+#include "player_store.h"
+#include "render.h"
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+const unsigned VIEW_CHUNK = 128;		///< Most rows of a chunk
+
+/**
+ * @brief Player in a view, name is stored inline like in the store, the
+ *	rank is the position in the view
+ */
+struct View_row
+{
+	char name[SLOT_NAME];		///< Name, not terminated
+	unsigned char len;			///< Length of the name
+	int score;					///< Score of the player
+	Pl_id id;					///< Id of the player
+
+	std::string_view get_name() const { return std::string_view(name, len); }
+};
+
+/**
+ * @brief Rows of a view in one chunk
+ */
+struct View_part
+{
+	const View_row *rows;
+	unsigned size;
+};
+
+/**
+ * @brief Ranking of the board at one version, never changed while a
+ *	reader holds it
+ */
+class Board_view
+{
+	public:
+		std::vector<View_part> parts;	///< Players in the order of ranking
+		std::size_t count;				///< Number of the players
+		std::uint64_t version;			///< Version of the board
+		int show_max;					///< How many players are shown
+		unsigned max_players;			///< Player limit
+		Pl_id next_id;					///< Id of the next new player
+		std::shared_ptr<const void> chunks;	///< Keeps the rows allocated
+
+		Board_view(): count{0}, version{0}, show_max{0}, max_players{0},
+						next_id{0} {}
+
+		std::size_t size() const { return count; }
+		template<typename F>
+		void for_each(F func, std::size_t limit = ~std::size_t(0)) const;
+
+		void render(Table_render &render) const;
+		void print(std::ostream &strm, Table_render &render) const;
+		bool save(const std::string &path) const;
+};
+
+/**
+ * @brief Draft of the next view, changed only by the writer
+ */
+class View_draft
+{
+		/**
+		 * @brief Rows of a part of the ranking
+		 */
+		struct Chunk
+		{
+			std::uint64_t made;			///< Draft the chunk was made in
+			View_row rows[VIEW_CHUNK];
+		};
+
+		/**
+		 * @brief All the chunks, owned until the last view is released
+		 */
+		struct Pool
+		{
+			std::vector<std::unique_ptr<Chunk>> all;
+		};
+
+		std::shared_ptr<Pool> pool;
+		std::vector<Chunk *> chunks;		///< Rows in the order of ranking
+		std::vector<View_part> parts;		///< Rows of each chunk
+		std::vector<std::size_t> sums;		///< Fenwick tree of the sizes
+		bool sums_stale;					///< Chunks were added or removed
+		std::size_t count;					///< Number of the rows
+		std::uint64_t draft;				///< Views published before
+		std::vector<Chunk *> free_c;		///< Chunks in no view
+		///< chunks replaced in the draft, with the first draft without them
+		std::vector<std::pair<Chunk *, std::uint64_t>> retired;
+		///< published views with their drafts, reused once no reader holds
+		///< them
+		std::vector<std::pair<std::shared_ptr<Board_view>, std::uint64_t>>
+			views;
+	public:
+		View_draft(): pool{std::make_shared<Pool>()}, sums_stale{true},
+						count{0}, draft{0} {}
+		View_draft(const View_draft &) = delete;
+		View_draft &operator=(const View_draft &) = delete;
+
+		void clear();
+		void push_back(std::string_view name, int score, Pl_id id);
+		void insert(std::size_t pos, std::string_view name, int score,
+					Pl_id id);
+		void erase(std::size_t pos);
+		std::shared_ptr<const Board_view> publish(std::uint64_t version,
+									int show_max, unsigned max_players,
+									Pl_id next_id);
+	private:
+		std::size_t locate(std::size_t &pos);
+		void resize(std::size_t c, int diff);
+		View_row *own(std::size_t c);
+		Chunk *take();
+		void retire(Chunk *chunk);
+		void reclaim();
+		static void set_row(View_row &row, std::string_view name, int score,
+							Pl_id id);
+};
+
+/**
+ * @brief Walks the players of the view in the order of their ranking
+ * @param func Called with the rank and the row of the player
+ * @param limit Maximum number of players visited
+ */
+template<typename F>
+void Board_view::for_each(F func, std::size_t limit) const
+{
+	int rank = 1;
+	for (const View_part &part : parts)
+		for (unsigned i = 0; i < part.size; i++)
+		{
+			if (static_cast<std::size_t>(rank) > limit)
+				return;
+			func(rank++, part.rows[i]);
+		}
+}
+
+#endif	// include BOARD_VIEW_H
@@ -0,0 +1,72 @@
+/**
+ * @file file_map.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the read only file mapping
+ */
+
+#include "file_map.h"
+#include "scoreboard.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>		// open
+#include <sys/mman.h>	// mmap
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+/**
+ * @brief Maps a file, the pages are read ahead sequentially
+ * @param path Path of the file
+ * @return True on success
+ */
+bool File_map::open(const std::string &path)
+{
+	debug_info();
+
+	close();
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		report_err("Cannot open file " << path << ": " <<
+					std::strerror(errno), false);
+
+	struct stat st;
+	if (::fstat(fd, &st) || !S_ISREG(st.st_mode))
+	{
+		::close(fd);
+		report_err("File " << path << " is not a regular file", false);
+	}
+
+	len = st.st_size;
+	if (!len)				// nothing to map, an empty text
+	{
+		::close(fd);
+		return true;
+	}
+
+	addr = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (addr == MAP_FAILED)
+	{
+		addr = nullptr;
+		len = 0;
+		report_err("Cannot map file " << path << ": " <<
+					std::strerror(errno), false);
+	}
+
+	::madvise(addr, len, MADV_SEQUENTIAL);
+	return true;
+}
+
+/**
+ * @brief Unmaps the file
+ */
+void File_map::close()
+{
+	if (addr)
+		::munmap(addr, len);
+
+	addr = nullptr;
+	len = 0;
+}
@@ -0,0 +1,38 @@
+/**
+ * @file file_map.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Text file mapped to the memory, read only, so it is parsed in
+ *	place without copying it into streams or strings
+ */
+
+#ifndef FILE_MAP_H
+#define FILE_MAP_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Read only mapping of a whole file, an empty file maps nothing
+ */
+class File_map
+{
+		void *addr;				///< Start of the mapping
+		std::size_t len;		///< Length of the file
+	public:
+		File_map(): addr{nullptr}, len{0} {}
+		File_map(const File_map &) = delete;
+		File_map &operator=(const File_map &) = delete;
+
+		bool open(const std::string &path);
+		void close();
+
+		const char *data() const { return static_cast<const char *>(addr); }
+		std::size_t size() const { return len; }
+		std::string_view text() const { return std::string_view(data(), len); }
+
+		~File_map() { close(); }
+};
+
+#endif	// include FILE_MAP_H
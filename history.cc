@@ -0,0 +1,117 @@
+/**
+ * @file history.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the history file reader
+ */
+
+#include "history.h"
+#include "name_check.h"
+#include "scoreboard.h"
+#include <charconv>
+#include <cstring>
+
+
+/**
+ * @brief Reads the next table row, lines which are not rows are skipped
+ * @param row Output, the player of a valid row
+ * @param msg Output, what is wrong with a bad row, nullptr if it is valid
+ * @return False at the end of the text
+ */
+bool History_reader::next(History_row &row, const char *&msg)
+{
+	while (!rest.empty())
+	{
+		const char *nl = static_cast<const char *>(
+							std::memchr(rest.data(), '\n', rest.size()));
+		std::size_t len = nl ? nl - rest.data() : rest.size();
+		std::string_view line = rest.substr(0, len);
+		rest.remove_prefix(nl ? len + 1 : len);
+		lines++;
+
+		if (parse_row(line, row, msg))
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * @brief Parses one line, the name is between the first two and the score
+ *	between the last two column borders
+ * @param line Line without its end
+ * @param row Output, the player of a valid row
+ * @param msg Output, error message of a bad row, nullptr if it is valid
+ * @return True if the line is a row of players, valid or bad
+ */
+bool History_reader::parse_row(std::string_view line, History_row &row,
+								const char *&msg)
+{
+	line = trim(line);
+	if (line.size() < 2 || line.front() != '|')		// borders, other text
+		return false;
+
+	msg = "Broken table row, expected | <rank>. | <name> | <score> |";
+	std::size_t rank_end = line.find('|', 1);
+	std::size_t score_at = line.rfind('|', line.size() - 2);
+	if (line.back() != '|' || rank_end >= score_at)
+		return true;
+
+	std::string_view rank = trim(line.substr(1, rank_end - 1));
+	if (rank == "RANK")							// header of a table
+		return false;
+	if (rank.size() < 2 || rank.back() != '.' ||
+		rank.find_first_not_of("0123456789") != rank.size() - 1)
+	{
+		msg = "Wrong format of rank";
+		return true;
+	}
+
+	row.name = trim(line.substr(rank_end + 1, score_at - rank_end - 1));
+	if (row.name.empty())
+	{
+		msg = "Missing player name";
+		return true;
+	}
+	// names with their "(N)" suffixes, the grammar applies to the base
+	if (row.name.size() > PNAME_LIMIT)
+	{
+		msg = "Player name too long, maximum 40 characters";
+		return true;
+	}
+	unsigned suffix;
+	if (!valid_name(Suffix_index::split(row.name, suffix)))
+	{
+		msg = "Player name can contain only letters, digits and _@$*-";
+		return true;
+	}
+
+	std::string_view num = trim(line.substr(score_at + 1,
+											line.size() - score_at - 2));
+	auto res = std::from_chars(num.data(), num.data() + num.size(),
+								row.score);
+	// totals are not limited, only the changes, any printed one is read
+	if (res.ec == std::errc::result_out_of_range)
+		msg = "Score out of range";
+	else if (num.empty() || res.ec != std::errc() ||
+		res.ptr != num.data() + num.size())
+		msg = "Wrong format of score";
+	else
+		msg = nullptr;
+
+	return true;
+}
+
+/**
+ * @brief Removes the padding around a column or a line
+ * @param s Text
+ * @return Text without leading and trailing spaces, tabs and '\r'
+ */
+std::string_view History_reader::trim(std::string_view s)
+{
+	std::size_t start = s.find_first_not_of(" \t\r");
+	if (start == std::string_view::npos)
+		return {};
+
+	return s.substr(start, s.find_last_not_of(" \t\r") - start + 1);
+}
@@ -0,0 +1,48 @@
+/**
+ * @file history.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Reader of history files, score tables printed by the scoreboard
+ *	Row format: "| <rank>. | <name> | <score> |", columns are padded by
+ *	spaces or tabs to any width, so tables printed on terminals of any
+ *	width are read. Border lines, headers and lines outside of a table
+ *	are skipped, a file may hold many tables. The text is walked once and
+ *	rows are returned one at a time as views into it, no line is copied.
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <cstddef>
+#include <string_view>
+
+const unsigned HISTORY_SHOWN = 10;		///< Bad rows reported in full
+
+/**
+ * @brief Player of a table row
+ */
+struct History_row
+{
+	std::string_view name;		///< Player name, points into the text
+	int score;					///< Player score
+};
+
+/**
+ * @brief Reads the rows of the tables in a text, in the order of the text
+ */
+class History_reader
+{
+		std::string_view rest;		///< Text after the last read line
+		std::size_t lines;			///< Lines read
+	public:
+		explicit History_reader(std::string_view text): rest{text}, lines{0} {}
+
+		bool next(History_row &row, const char *&msg);
+		std::size_t line() const { return lines; }	///< Line of the last row
+	private:
+		static bool parse_row(std::string_view line, History_row &row,
+								const char *&msg);
+		static std::string_view trim(std::string_view s);
+};
+
+#endif	// include HISTORY_H
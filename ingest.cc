@@ -0,0 +1,237 @@
+/**
+ * @file ingest.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the ingest queue of score events and its applier
+ */
+
+#include "ingest.h"
+#include "scoreboard.h"
+#include <cstring>
+
+
+/**
+ * @brief Stores the name of the player, a name too long to be a player
+ *	name is stored empty, so it matches no player
+ * @param n Name of the player
+ */
+void Score_event::set_name(std::string_view n)
+{
+	len = n.size() <= SLOT_NAME ? n.size() : 0;
+	std::memcpy(name, n.data(), len);
+}
+
+/**
+ * @brief Creates an empty queue
+ * @param size Capacity, rounded up to a power of two, at least 2
+ */
+Ingest_queue::Ingest_queue(std::size_t size): tail{0}, head{0}
+{
+	std::size_t cap = 2;
+	while (cap < size)
+		cap *= 2;
+
+	cells = std::make_unique<Cell[]>(cap);
+	mask = cap - 1;
+	for (std::size_t i = 0; i < cap; i++)
+		cells[i].seq.store(i, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Puts an event at the tail, any thread can push
+ * @param ev Score event
+ * @return False if the queue is full
+ */
+bool Ingest_queue::push(const Score_event &ev)
+{
+	std::size_t pos = tail.load(std::memory_order_relaxed);
+	Cell *cell;
+
+	for (;;)
+	{
+		cell = &cells[pos & mask];
+		std::size_t seq = cell->seq.load(std::memory_order_acquire);
+		std::intptr_t dif = static_cast<std::intptr_t>(seq) -
+							static_cast<std::intptr_t>(pos);
+
+		if (!dif && tail.compare_exchange_weak(pos, pos + 1,
+												std::memory_order_relaxed))
+			break;					// cell at pos is ours
+		if (dif < 0)
+			return false;			// cell still holds an event of the last lap
+		if (dif > 0)
+			pos = tail.load(std::memory_order_relaxed);	// another producer won
+	}
+
+	cell->ev = ev;
+	cell->seq.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+/**
+ * @brief Takes events from the head, only one thread at a time can pop
+ * @param out Output, taken events
+ * @param max Most events taken
+ * @return Number of taken events, stops at a cell not filled yet
+ */
+std::size_t Ingest_queue::pop(Score_event *out, std::size_t max)
+{
+	std::size_t pos = head.load(std::memory_order_relaxed);
+	std::size_t n = 0;
+
+	for (; n < max; n++, pos++)
+	{
+		Cell &cell = cells[pos & mask];
+		if (cell.seq.load(std::memory_order_acquire) != pos + 1)
+			break;
+
+		out[n] = cell.ev;
+		cell.seq.store(pos + mask + 1, std::memory_order_release);	// next lap
+	}
+
+	head.store(pos, std::memory_order_relaxed);
+	return n;
+}
+
+/**
+ * @brief Creates the queue and starts the applier thread
+ * @param size Capacity of the queue
+ * @param policy What producers do when the queue is full
+ * @param on_tick Run by the applier with the board held, after every
+ *	batch and when idle, nullptr for none
+ * @return True on success, false if already running
+ */
+bool Ingest::start(std::size_t size, Ingest_full policy,
+					std::function<void()> on_tick)
+{
+	debug_info();
+
+	if (running())
+		report_err("Ingest of score events already started", false);
+
+	queue = std::make_unique<Ingest_queue>(size);
+	taken.resize(INGEST_DRAIN);
+	full = policy;
+	tick = std::move(on_tick);
+	stopping.store(false);
+	applier = std::thread(&Ingest::run, this);
+	return true;
+}
+
+/**
+ * @brief Stops the applier, the pending events are applied first, only
+ *	after the producers stopped
+ */
+void Ingest::stop()
+{
+	if (!running())
+		return;
+
+	stopping.store(true);
+	notify();
+	applier.join();
+
+	{
+		std::lock_guard<std::mutex> lock(board_m);
+		drain();				// pushed while the applier was ending
+	}
+	queue.reset();
+}
+
+/**
+ * @brief Puts a score event into the queue, a full queue is handled by
+ *	the policy, wakes the applier if it is idle
+ * @param ev Score event
+ * @return False if the event was rejected
+ */
+bool Ingest::submit(const Score_event &ev)
+{
+	while (!queue->push(ev))
+	{
+		if (full == IF_DROP)
+		{
+			scb_stats.count(STAT_DROPPED);
+			return true;
+		}
+		if (full == IF_REJECT)
+		{
+			scb_stats.count(STAT_REJECTED);
+			return false;
+		}
+
+		notify();				// IF_BLOCK, the applier makes space
+		std::this_thread::yield();
+	}
+
+	// pairs with the fence of run, either the applier sees the event, or
+	// this thread sees the applier idle
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (idle.load(std::memory_order_relaxed))
+		notify();
+
+	return true;
+}
+
+/**
+ * @brief Applies all the pending events, the caller holds board()
+ */
+void Ingest::drain()
+{
+	while (running() && apply())
+		;
+}
+
+/**
+ * @brief Applies one batch of the pending events, the caller holds board()
+ * @return Number of applied events
+ */
+std::size_t Ingest::apply()
+{
+	std::size_t n = queue->pop(taken.data(), taken.size());
+	if (!n)
+		return 0;
+
+	std::size_t missed = scb.apply_scores(taken.data(), n);
+	scb_stats.count(STAT_INGESTED, n - missed);
+	scb_stats.count(STAT_MISSED, missed);
+	scb_stats.count(STAT_DRAINS);
+	return n;
+}
+
+/**
+ * @brief Applier thread, takes batches while there are events, waits
+ *	while there are none
+ */
+void Ingest::run()
+{
+	for (;;)
+	{
+		std::size_t n;
+		{
+			std::lock_guard<std::mutex> lock(board_m);
+			n = apply();
+			if (tick)
+				tick();
+		}
+		if (n)
+			continue;
+		if (stopping.load())
+			return;
+
+		std::unique_lock<std::mutex> lock(wake_m);
+		idle.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!queue->pending() && !stopping.load())
+			wake.wait_for(lock, INGEST_IDLE);
+		idle.store(false, std::memory_order_relaxed);
+	}
+}
+
+/**
+ * @brief Wakes the applier
+ */
+void Ingest::notify()
+{
+	std::lock_guard<std::mutex> lock(wake_m);
+	wake.notify_one();
+}
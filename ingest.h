@@ -0,0 +1,137 @@
+/**
+ * @file ingest.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Ingest of score events, producers on any thread put the events
+ *	into a bounded lock-free queue, one applier thread takes them out in
+ *	batches and applies each batch to the board at once, every changed
+ *	player is re-ranked once per batch however many events he got.
+ *	The board is changed only by the one holding board(), the applier or
+ *	the thread executing the other commands, which applies the pending
+ *	events first, so the events of one producer keep their order.
+ *	The applier runs a tick with the board held after every batch and at
+ *	least every INGEST_IDLE, work due between the commands is done there
+ *	while no command comes.
+ */
+
+#ifndef INGEST_H
+#define INGEST_H
+
+#include "player_store.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+class Scoreboard;
+
+const std::size_t INGEST_SIZE = 4096;		///< Default queue capacity
+const std::size_t INGEST_DRAIN = 1024;		///< Most events of one batch
+const std::chrono::milliseconds INGEST_IDLE{50};	///< Longest idle wait
+
+/**
+ * @brief What a producer does when the queue is full
+ */
+enum Ingest_full
+{
+	IF_BLOCK,		///< Waits until the applier makes space
+	IF_DROP,		///< Event is lost, the producer is not told
+	IF_REJECT		///< Event is refused, the producer reports an error
+};
+
+/**
+ * @brief Score change of a player given by his id, or by his name if the
+ *	id is 0, name is stored inline, so an event is never allocated
+ */
+struct Score_event
+{
+	Pl_id id;					///< Id of the player, 0 if given by name
+	int num;					///< Number added to the score
+	unsigned char len;			///< Length of the name
+	char name[SLOT_NAME];		///< Name, not terminated
+
+	void set_name(std::string_view n);
+	std::string_view get_name() const { return std::string_view(name, len); }
+};
+
+/**
+ * @brief Bounded multi-producer single-consumer queue, every cell has a
+ *	sequence number telling whose turn it is, so producers only race for
+ *	the tail index and never wait for each other (D. Vyukov's design)
+ */
+class Ingest_queue
+{
+		/**
+		 * @brief Cell of the ring, free for the producer of position pos
+		 *	if seq == pos, filled for the consumer if seq == pos + 1
+		 */
+		struct Cell
+		{
+			std::atomic<std::size_t> seq;
+			Score_event ev;
+		};
+
+		std::unique_ptr<Cell[]> cells;
+		std::size_t mask;							///< Capacity - 1
+		alignas(64) std::atomic<std::size_t> tail;	///< Next position to fill
+		alignas(64) std::atomic<std::size_t> head;	///< Next position to take
+	public:
+		explicit Ingest_queue(std::size_t size);
+		Ingest_queue(const Ingest_queue &) = delete;
+		Ingest_queue &operator=(const Ingest_queue &) = delete;
+
+		bool push(const Score_event &ev);
+		std::size_t pop(Score_event *out, std::size_t max);
+		bool pending() const
+		{
+			return tail.load() != head.load(std::memory_order_relaxed);
+		}
+		std::size_t capacity() const { return mask + 1; }
+};
+
+/**
+ * @brief Queue of score events with its applier thread
+ */
+class Ingest
+{
+		Scoreboard &scb;
+		std::unique_ptr<Ingest_queue> queue;
+		Ingest_full full;						///< Policy of a full queue
+		std::vector<Score_event> taken;			///< Batch being applied
+		std::function<void()> tick;				///< Run by the applier
+		std::thread applier;
+
+		std::mutex board_m;						///< Held while the board changes
+		std::mutex wake_m;						///< Guards the idle wait
+		std::condition_variable wake;			///< Wakes the idle applier
+		std::atomic<bool> idle;					///< Applier waits for events
+		std::atomic<bool> stopping;				///< Applier has to end
+	public:
+		explicit Ingest(Scoreboard &board): scb{board}, full{IF_BLOCK},
+											idle{false}, stopping{false} {}
+		Ingest(const Ingest &) = delete;
+		Ingest &operator=(const Ingest &) = delete;
+
+		bool start(std::size_t size, Ingest_full policy,
+					std::function<void()> on_tick = nullptr);
+		void stop();
+		bool running() const { return queue != nullptr; }
+
+		bool submit(const Score_event &ev);
+		std::mutex &board() { return board_m; }
+		void drain();
+
+		~Ingest() { stop(); }
+	private:
+		std::size_t apply();
+		void run();
+		void notify();
+};
+
+#endif	// include INGEST_H
@@ -8,61 +8,115 @@
 
 #include "interface.h"
 #include "scoreboard.h"
+#include "snapshot.h"
+#include "stats.h"
+#include "server.h"
+#include "table_writer.h"
+#include "snap_fork.h"
 #include <unistd.h>
 #include <cctype>
-#include <unordered_map>
+#include <charconv>
+#include <chrono>
+#include <ctime>
 #include <algorithm>
 #include <sstream>
 
 
-static std::vector<std::string> v_exstr;
-static std::unordered_map<std::string, user_cmnds> m_cmd_parse;
+static Cmd_tokens v_exstr;
 static Scoreboard scb;
+static std::string save_path;	///< Save file, set by -sf or "set file"
+static std::string listen_path;	///< Socket of the server mode, --listen
+static Ingest ingest(scb);		///< Queue of score events, --ingest
+static Table_writer table_out(scb);	///< Writer of the table file, -tf
+static Snap_fork snaps(scb);		///< Snapshots written by children, -as
+
+const unsigned CMD_COUNT = UC_STATS - UC_PRINT + 1;
+///< Latencies of the main commands, indexed by code - UC_PRINT
+static Histogram cmd_stats[CMD_COUNT];
+const char *const cmd_names[CMD_COUNT] = {"print", "scoreboard", "show",
+	"score", "player", "win", "loss", "set", "save", "load", "help", "exit",
+	"begin", "commit", "abort", "compact", "find", "complete", "history",
+	"board", "undo", "redo", "snapshot", "stats"};
 
 /**
- * @brief Initializes map 
+ * @brief Keyword table, commands and subcommands and their codes, words
+ *	are compared only with the keywords of the same length
+ * @param word Word of the command line
+ * @return Code of the keyword, UC_NONE if the word is not a keyword
  */
-static std::unordered_map<std::string, user_cmnds> m_cmd_init()
+static constexpr user_cmnds cmd_code(std::string_view word)
 {
-	// initialized map with appropriate keywords - commands and their
-	// codes
-	std::unordered_map<std::string, user_cmnds> m_aux ( 
-		{{"print", UC_PRINT}, {"scoreboard", UC_SCOREBOARD}, 
-		{"show", UC_SHOW}, {"score", UC_SCORE}, {"player", UC_PLAYER}, 
-		{"win", UC_WIN}, {"loss", UC_LOSS}, {"set", UC_SET}, 
-		{"save", UC_SAVE}, {"load", UC_LOAD}, {"add", SC_ADD}, 
-		{"remove", SC_REMOVE}, {"rename", SC_RENAME}, {"reset", SC_RESET}, 
-		{"plimit", SC_MAX}, {"file", SC_FILE}, {"history", SC_HISTORY}, 
-		{"players", SC_PLAYERS}, {"all", SC_ALL}, {"help", UC_HELP},
-		{"exit", UC_EXIT}});
-
-	return m_aux;
+	switch(word.size())
+	{
+		case 2:
+			return word == "id" ? SC_ID : word == "at" ? SC_AT : UC_NONE;
+		case 3:
+			return word == "win" ? UC_WIN : word == "set" ? UC_SET :
+				word == "add" ? SC_ADD : word == "all" ? SC_ALL : UC_NONE;
+		case 4:
+			return word == "show" ? UC_SHOW : word == "loss" ? UC_LOSS :
+				word == "save" ? UC_SAVE : word == "load" ? UC_LOAD :
+				word == "help" ? UC_HELP : word == "exit" ? UC_EXIT :
+				word == "file" ? SC_FILE : word == "find" ? UC_FIND :
+				word == "undo" ? UC_UNDO : word == "redo" ? UC_REDO : UC_NONE;
+		case 5:
+			return word == "print" ? UC_PRINT : word == "score" ? UC_SCORE :
+				word == "reset" ? SC_RESET : word == "begin" ? UC_BEGIN :
+				word == "abort" ? UC_ABORT : word == "stats" ? UC_STATS :
+				word == "board" ? UC_BOARD : UC_NONE;
+		case 6:
+			return word == "player" ? UC_PLAYER : 
+				word == "remove" ? SC_REMOVE : word == "rename" ? SC_RENAME :
+				word == "plimit" ? SC_MAX : word == "commit" ? UC_COMMIT :
+				UC_NONE;
+		case 7:
+			return word == "history" ? UC_HISTORY : 
+				word == "players" ? SC_PLAYERS : 
+				word == "compact" ? UC_COMPACT : UC_NONE;
+		case 8:
+			return word == "complete" ? UC_COMPLETE :
+				word == "snapshot" ? UC_SNAPSHOT : UC_NONE;
+		case 10:
+			return word == "scoreboard" ? UC_SCOREBOARD : UC_NONE;
+		default:
+			return UC_NONE;
+	}
 }
 
+static_assert(cmd_code("scoreboard") == UC_SCOREBOARD && 
+				cmd_code("plimit") == SC_MAX && cmd_code("wins") == UC_NONE,
+				"Keyword table is broken");
+
 /**
- * @brief Splits string into a vector of string based on whitespace
- * @param str String to be split
+ * @brief Splits a command line into tokens separated by whitespace, the
+ *	tokens point into the line, nothing is copied
+ * @param line Command line
  */
-static void split_str(std::string &str)
+void Cmd_tokens::split(std::string_view line)
 {
-	std::string aux;
-	v_exstr.clear();	// delete any previous strings
-	int i = 0, j = 0;
+	cnt = 0;
+	for (auto &t : tok)
+		t = std::string_view();
 
-	for (std::string::iterator it = str.begin(); it != str.end(); it++, i++)
+	std::size_t i = 0;
+	while (i < line.size())
 	{
-		if ( std::isspace(*it) )		// char is whitespace
-		{
-			aux = str.substr(j, i);		// only string without whitespace
-			if (aux.length())			// is not whitespace only
-				v_exstr.push_back(aux);
+		while (i < line.size() && std::isspace(
+				static_cast<unsigned char>(line[i])))
+			i++;
+
+		std::size_t start = i;
+		while (i < line.size() && !std::isspace(
+				static_cast<unsigned char>(line[i])))
+			i++;
 
-			j += ++i; i = -1;			// moves j, resets i
+		if (i > start)
+		{
+			if (cnt < CMD_MAX_TOKENS)
+				tok[cnt] = line.substr(start, i - start);
+			cnt++;				// too many tokens are only counted
 		}
 	}
-	aux = str.substr(j, i);			// without newline
-	if (aux.length())
-		v_exstr.push_back(aux);
 }
 
 /**
@@ -71,10 +125,13 @@ static void split_str(std::string &str)
  * @param s String to be checked
  * @return True if number else false
  */
-static bool is_num_gen(const std::string &s)
+static bool is_num_gen(std::string_view s)
 {
 	debug_info();
-	std::string::const_iterator it = s.begin();
+	std::string_view::const_iterator it = s.begin();
+
+	if (s.empty())
+		return false;
 
 	// always runs for the first char
 	if (*it != '+' && *it != '-' && !(std::isdigit(*it)) )
@@ -97,13 +154,52 @@ static bool is_num_gen(const std::string &s)
  * @param s String to be checked
  * @return True if number else false
  */
-static bool is_num_only(const std::string &s)
+static bool is_num_only(std::string_view s)
 {
 	debug_info();
 	return !s.empty() && std::find_if(s.begin(), s.end(), 
 		[](char c) { return !std::isdigit(c); }) == s.end();
 }
 
+/**
+ * @brief Checks if a string is a reference to a player id, "#N"
+ * @param s String to be checked
+ * @return True if id reference else false
+ */
+static bool is_id(std::string_view s)
+{
+	return s.size() > 1 && s[0] == '#' && is_num_only(s.substr(1));
+}
+
+/**
+ * @brief Converts a number checked by is_num_gen or is_num_only, numbers
+ *	out of range of int are saturated
+ * @param s String with the number
+ * @return The number
+ */
+static int to_int(std::string_view s)
+{
+	if (!s.empty() && s[0] == '+')
+		s.remove_prefix(1);
+
+	int num = 0;
+	auto res = std::from_chars(s.data(), s.data() + s.size(), num);
+	if (res.ec == std::errc::result_out_of_range)
+		num = s[0] == '-' ? INT_MIN : INT_MAX;
+
+	return num;
+}
+
+/**
+ * @brief Converts an id reference checked by is_id
+ * @param s String with the reference
+ * @return The id, out of range ids are not given to any player
+ */
+static Pl_id to_id(std::string_view s)
+{
+	return Pl_id{static_cast<std::uint32_t>(to_int(s.substr(1)))};
+}
+
 /**
  * @brief Outputs starting symbol of scoreboard
  */
@@ -139,7 +235,7 @@ void uc_score()
 			scb.print();
 			return;
 		case 3:				
-			switch(m_cmd_parse[v_exstr[1]])
+			switch(cmd_code(v_exstr[1]))
 			{
 				case SC_ADD:	// "score add (<name> | <rank>) 
 					sc_add_sc();
@@ -152,7 +248,7 @@ void uc_score()
 			}
 			break;
 		case 4:			
-			if (m_cmd_parse[v_exstr[1]] == SC_ADD)
+			if (cmd_code(v_exstr[1]) == SC_ADD)
 			{
 				sc_add_scn();	// "score add (<name> | <rank>) <number>"
 				return;
@@ -165,15 +261,17 @@ void uc_score()
 
 /**
  * @brief Subcommand "add" of "score" command
- *  "score add (<name> | <rank>)"
+ *  "score add (<name> | <rank> | #<id>)"
  */
 void sc_add_sc()
 {
 	debug_info();
 	if (v_exstr.size() == 3)
 	{
-		if ( is_num_only(v_exstr[2]))	// checking rank correctness
-			scb.add_pscore(std::stoi(v_exstr[2]));	// "score add <rank>"
+		if (is_id(v_exstr[2]))
+			scb.add_pscore(to_id(v_exstr[2]));		// "score add #<id>"
+		else if ( is_num_only(v_exstr[2]))	// checking rank correctness
+			scb.add_pscore(to_int(v_exstr[2]));	// "score add <rank>"
 		else
 			scb.add_pscore(v_exstr[2]);				// "score add <name>"
 	}
@@ -181,18 +279,20 @@ void sc_add_sc()
 
 /**
  * @brief Subcommand "add" of "score" command
- *  "score add (<name> | <rank>) <number>"
+ *  "score add (<name> | <rank> | #<id>) <number>"
  */
 void sc_add_scn()
 {
 	debug_info();
 	if (is_num_gen(v_exstr[3]))	// "score add (<name>|<rank>)<number>"
 	{
-		if ( is_num_only(v_exstr[2]))				// checking rank is num
-			scb.add_pscore(std::stoi(v_exstr[2]), 
-							std::stoi(v_exstr[3]));			  // using rank
+		if (is_id(v_exstr[2]))
+			scb.add_pscore(to_id(v_exstr[2]), to_int(v_exstr[3]));	// id
+		else if ( is_num_only(v_exstr[2]))				// checking rank is num
+			scb.add_pscore(to_int(v_exstr[2]), 
+							to_int(v_exstr[3]));			  // using rank
 		else					
-			scb.add_pscore(v_exstr[2], std::stoi(v_exstr[3]));// using name
+			scb.add_pscore(v_exstr[2], to_int(v_exstr[3]));// using name
 			
 	} else
 		report_err("Wrong format of number", void());
@@ -201,20 +301,22 @@ void sc_add_scn()
 /**
  * @brief Subcommand "reset"
  *	score -> reset -> all
- *	score -> reset -> (<name>|<rank>)
+ *	score -> reset -> (<name>|<rank>|#<id>)
  */
 void sc_reset()
 {
 	debug_info();
 
-	if (m_cmd_parse[v_exstr[2]] == SC_ALL)
+	if (cmd_code(v_exstr[2]) == SC_ALL)
 		scb.reset_score();
 	else
 	{
-		if (is_num_only(v_exstr[2]))		// is rank
-			scb.reset_pscore(std::stoi(v_exstr[3]));
+		if (is_id(v_exstr[2]))				// is id
+			scb.reset_pscore(to_id(v_exstr[2]));
+		else if (is_num_only(v_exstr[2]))		// is rank
+			scb.reset_pscore(to_int(v_exstr[2]));
 		else
-			scb.reset_pscore(v_exstr[3]);	// is name
+			scb.reset_pscore(v_exstr[2]);	// is name
 	}
 }
 
@@ -223,12 +325,13 @@ void sc_reset()
  * 	player 	-> add [<name>] [<score>]
  *			-> remove -> all
  * 			-> rename -> (<name> | <rank>) <new_name>
+ *			-> id -> (<name> | <rank>)
  */
 void uc_player()
 {
 	debug_info();
 
-	switch(m_cmd_parse[v_exstr[1]])
+	switch(cmd_code(v_exstr[1]))
 	{
 		case SC_ADD:
 			sc_add_p();
@@ -239,6 +342,9 @@ void uc_player()
 		case SC_RENAME:
 			sc_rename();
 			break;
+		case SC_ID:
+			sc_id();
+			break;
 		default:
 			report_err("Unknown subcommand", void());
 	}
@@ -264,7 +370,7 @@ void sc_add_p()
 		case 4:			// player add <name> <score>
 			if (is_num_gen(v_exstr[3]))
 			{
-				scb.add_player(v_exstr[2], std::stoi(v_exstr[3]));
+				scb.add_player(v_exstr[2], to_int(v_exstr[3]));
 				break;
 			}
 			[[fallthrough]];	// C++17 
@@ -276,7 +382,7 @@ void sc_add_p()
 /**
  * @brief Subcommand "remove" of "player" command
  *	player -> remove -> all
- * 	player -> remove -> (<name> | <rank>)
+ * 	player -> remove -> (<name> | <rank> | #<id>)
  */
 void sc_remove()
 {
@@ -286,13 +392,15 @@ void sc_remove()
 		report_err("Unknown subcommand", void());
 
 	// player remove all
-	if (m_cmd_parse[v_exstr[2]] == SC_ALL)
+	if (cmd_code(v_exstr[2]) == SC_ALL)
 		scb.rm_players();
 	else
 	{
-		// player remove (<name> | <rank>)
-		if (is_num_only(v_exstr[2]))
-			scb.rm_player(std::stoi(v_exstr[2]));
+		// player remove (<name> | <rank> | #<id>)
+		if (is_id(v_exstr[2]))
+			scb.rm_player(to_id(v_exstr[2]));
+		else if (is_num_only(v_exstr[2]))
+			scb.rm_player(to_int(v_exstr[2]));
 		else
 			scb.rm_player(v_exstr[2]);
 	}
@@ -300,22 +408,43 @@ void sc_remove()
 
 /**
  * @brief Subcommand "rename" of "player" command
- * 	player -> rename -> (<name> | <rank>) <new_name>
+ * 	player -> rename -> (<name> | <rank> | #<id>) <new_name>
  */
 void sc_rename()
 {
 	if (v_exstr.size() != 4)
 		report_err("Unknown subcommand", void());
 	
-	if (is_num_only(v_exstr[2]))
-		scb.rename_player(std::stoi(v_exstr[2]), v_exstr[3]);
+	if (is_id(v_exstr[2]))
+		scb.rename_player(to_id(v_exstr[2]), v_exstr[3]);
+	else if (is_num_only(v_exstr[2]))
+		scb.rename_player(to_int(v_exstr[2]), v_exstr[3]);
 	else
 		scb.rename_player(v_exstr[2], v_exstr[3]);
 }
 
+/**
+ * @brief Subcommand "id" of "player" command, shows id of a player
+ * 	player -> id -> (<name> | <rank>)
+ */
+void sc_id()
+{
+	debug_info();
+
+	if (v_exstr.size() != 3)
+		report_err("Unknown subcommand", void());
+
+	Pl_id id = is_num_only(v_exstr[2]) ? scb.get_id(to_int(v_exstr[2])) :
+											scb.get_id(v_exstr[2]);
+	if (!id.num)
+		report_err("Player does not exist", void());
+
+	std::cout << "Player id: #" << id.num << std::endl;
+}
+
 /**
  * @brief "win" command, adds a score of 1 to a player
- *	win -> <name> | <rank>
+ *	win -> <name> | <rank> | #<id>
  */
 void uc_win()
 {
@@ -324,15 +453,17 @@ void uc_win()
 	if (v_exstr.size() != 2)
 		report_err("Unknown subcommand", void());
 
-	if (is_num_only(v_exstr[1]))
-		scb.add_pscore(std::stoi(v_exstr[1]));
+	if (is_id(v_exstr[1]))
+		scb.add_pscore(to_id(v_exstr[1]));
+	else if (is_num_only(v_exstr[1]))
+		scb.add_pscore(to_int(v_exstr[1]));
 	else
 		scb.add_pscore(v_exstr[1]);
 }
 
 /**
  * @brief "loss" command, decrements a score of a player by one
- *	loss -> <name> | <rank>
+ *	loss -> <name> | <rank> | #<id>
  */
 void uc_loss()
 {
@@ -341,16 +472,38 @@ void uc_loss()
 	if (v_exstr.size() != 2)
 		report_err("Unknown subcommand", void());
 
-	if (is_num_only(v_exstr[1]))
-		scb.add_pscore(std::stoi(v_exstr[1]), -1);
+	if (is_id(v_exstr[1]))
+		scb.add_pscore(to_id(v_exstr[1]), -1);
+	else if (is_num_only(v_exstr[1]))
+		scb.add_pscore(to_int(v_exstr[1]), -1);
 	else
 		scb.add_pscore(v_exstr[1], -1);
 }
 
+/**
+ * @brief Sets periodic snapshots to the save file
+ * @param seconds Period, 0 stops them
+ */
+static void set_snapshots(int seconds)
+{
+	if (seconds && save_path.empty())
+		report_err("No save file set, use: set file <path>", void());
+
+	snaps.set_every(save_path, seconds);
+	if (seconds)
+		std::cout << "Snapshot every " << seconds << " s to: " << save_path <<
+			std::endl;
+	else
+		std::cout << "Periodic snapshots stopped" << std::endl;
+}
+
 /**
  * @brief "set" command, sets scoreboard variables
  *	set -> show <M>		- sets maximum number of shown players
  *	set -> plimit <N>	- sets maximum number of players
+ *	set -> file <path>	- sets the save file
+ *	set -> undo <N>		- sets number of steps kept for undo
+ *	set -> snapshot <T>	- snapshots to the save file every T seconds
  */
 void uc_set()
 {
@@ -358,19 +511,37 @@ void uc_set()
 	if (v_exstr.size() != 3)
 		report_err("Unknown subcommand", void());
 
-	switch(m_cmd_parse[v_exstr[1]])
+	switch(cmd_code(v_exstr[1]))
 	{
 		case UC_SHOW:
 			if (is_num_only(v_exstr[2]))
 			{
-				scb.set_show_max(std::stoi(v_exstr[2]));
+				scb.set_show_max(to_int(v_exstr[2]));
 				break;
 			}
 			report_err("Unknown subcommand", void());
+		case SC_FILE:
+			save_path = v_exstr[2];
+			std::cout << "Save file set to: " << save_path << std::endl;
+			break;
 		case SC_MAX:
 			if (is_num_only(v_exstr[2]))
 			{
-				scb.set_max_players(std::stoi(v_exstr[2]));
+				scb.set_max_players(to_int(v_exstr[2]));
+				break;
+			}
+			report_err("Unknown subcommand", void());
+		case UC_UNDO:
+			if (is_num_only(v_exstr[2]))
+			{
+				scb.set_undo_depth(to_int(v_exstr[2]));
+				break;
+			}
+			report_err("Unknown subcommand", void());
+		case UC_SNAPSHOT:
+			if (is_num_only(v_exstr[2]))
+			{
+				set_snapshots(to_int(v_exstr[2]));
 				break;
 			}
 			[[fallthrough]];	// C++17 
@@ -380,23 +551,291 @@ void uc_set()
 }
 
 /**
- * @brief TODO
+ * @brief "save" command, saves a binary snapshot of the scoreboard
+ *	save					- to the save file
+ *	save -> [file] <path>	- to the file
+ *	save -> history <path>	- printed scoreboard to the file
  */
 void uc_save()
 {
 	debug_info();
-	
+
+	switch(v_exstr.size())
+	{
+		case 1:			// save
+			if (save_path.empty())
+				report_err("No save file set, use: set file <path>", void());
+			scb.save_to_file(save_path);
+			break;
+		case 2:			// save <path>
+			scb.save_to_file(std::string(v_exstr[1]));
+			break;
+		case 3:
+			switch(cmd_code(v_exstr[1]))
+			{
+				case SC_FILE:		// save file <path>
+					scb.save_to_file(std::string(v_exstr[2]));
+					break;
+				case UC_HISTORY:	// save history <path>
+					report_err("Saving history is not implemented yet", 
+								void());
+				default:
+					report_err("Unknown subcommand", void());
+			}
+			break;
+		default:
+			report_err("Unknown subcommand", void());
+	}
 }
 
 /**
- * @brief TODO
+ * @brief "snapshot" command, same as "save" but the file is written by
+ *	a child process, commands go on meanwhile
+ *	snapshot			- to the save file
+ *	snapshot <path>		- to the file
+ */
+void uc_snapshot()
+{
+	debug_info();
+
+	if (v_exstr.size() > 2)
+		report_err("Unknown subcommand", void());
+	if (v_exstr.size() == 1 && save_path.empty())
+		report_err("No save file set, use: set file <path>", void());
+
+	snaps.start(v_exstr.size() == 2 ? std::string(v_exstr[1]) : save_path);
+}
+
+/**
+ * @brief "load" command, loads data into the scoreboard
+ *	load -> [file] <path>	- replaces scoreboard with a binary snapshot
+ *	load -> history <path>	- adds players from a printed scoreboard
+ *	load -> players <path>	- adds players with names from a file
  */
 void uc_load()
 {
 	debug_info();
 
+	switch(v_exstr.size())
+	{
+		case 2:			// load <path>
+			scb.load_from_file(std::string(v_exstr[1]));
+			break;
+		case 3:
+			switch(cmd_code(v_exstr[1]))
+			{
+				case SC_FILE:		// load file <path>
+					scb.load_from_file(std::string(v_exstr[2]));
+					break;
+				case UC_HISTORY:	// load history <path>
+					scb.load_history(std::string(v_exstr[2]));
+					break;
+				case SC_PLAYERS:	// load players <path>
+					scb.load_players_from_file(std::string(v_exstr[2]));
+					break;
+				default:
+					report_err("Unknown subcommand", void());
+			}
+			break;
+		default:
+			report_err("Unknown subcommand", void());
+	}
+}
+
+/**
+ * @brief "stats" command, latencies of the commands and of their phases
+ *	stats [reset]
+ */
+void uc_stats()
+{
+	debug_info();
+
+	if (v_exstr.size() == 2 && cmd_code(v_exstr[1]) == SC_RESET)
+	{
+		for (auto &h : cmd_stats)
+			h.reset();
+		scb_stats.reset();
+		std::cout << "Statistics reset" << std::endl;
+		return;
+	}
+
+	if (v_exstr.size() != 1)
+		report_err("Unknown subcommand", void());
+
+	Histogram::print_head(std::cout, "COMMAND");
+	for (unsigned i = 0; i < CMD_COUNT; i++)
+		if (cmd_stats[i].samples())
+			cmd_stats[i].print_row(std::cout, cmd_names[i]);
+
+	scb_stats.print(std::cout);
+	std::cout.flush();
+}
+
+/**
+ * @brief "find" and "complete" commands, search of players by name
+ *	find [<prefix> | <pattern>]	- first players in the order of names
+ *	complete [<prefix>]			- common start of the names and the names
+ * @param cmd Code of the command
+ */
+void uc_find(user_cmnds cmd)
+{
+	debug_info();
+
+	if (v_exstr.size() > 2)
+		report_err("Unknown subcommand", void());
+
+	std::string_view what = v_exstr.size() == 2 ? v_exstr[1] : "";
+	if (cmd == UC_FIND)
+		scb.find_players(what);
+	else
+		scb.complete_name(what);
+}
+
+/**
+ * @brief "history" command, past score changes of a player
+ *	history (<name> | <rank> | #<id>)	- also of a removed player by id
+ */
+void uc_history()
+{
+	debug_info();
+
+	if (v_exstr.size() != 2)
+		report_err("Unknown subcommand", void());
+
+	Pl_id id = is_id(v_exstr[1]) ? to_id(v_exstr[1]) :
+				is_num_only(v_exstr[1]) ? scb.get_id(to_int(v_exstr[1])) :
+				scb.get_id(v_exstr[1]);
+	if (!id.num)
+		report_err("Player does not exist", void());
+
+	scb.print_series(id);
+}
+
+/**
+ * @brief Converts a past time of the "board at" command
+ * @param s Local time of today "HH:MM[:SS]", of yesterday if it is still
+ *	to come, or a time ago "-N[s|m|h]", seconds by default
+ * @param time Output, milliseconds since the epoch
+ * @return False if the format is wrong
+ */
+static bool to_past(std::string_view s, std::int64_t &time)
+{
+	std::int64_t now = Score_series::now();
+	if (s.size() > 1 && s[0] == '-')
+	{
+		std::int64_t unit = 1000;
+		switch (s.back())
+		{
+			case 'h': unit *= 60; // fall through
+			case 'm': unit *= 60; // fall through
+			case 's': s.remove_suffix(1);
+		}
+		if (!is_num_only(s.substr(1)))
+			return false;
+		time = now - to_int(s.substr(1)) * unit;
+		return true;
+	}
+
+	int hms[3] = {0, 0, 0};
+	unsigned parts = 0;
+	while (parts < 3)
+	{
+		std::size_t len = std::min(s.find(':'), s.size());
+		if (len != 2 || !is_num_only(s.substr(0, 2)))
+			return false;
+		hms[parts++] = to_int(s.substr(0, 2));
+		s.remove_prefix(len);
+		if (s.empty())
+			break;
+		s.remove_prefix(1);
+	}
+	if (parts < 2 || !s.empty() || hms[0] > 23 || hms[1] > 59 || hms[2] > 59)
+		return false;
+
+	std::time_t sec = now / 1000;
+	std::tm tm;
+	localtime_r(&sec, &tm);
+	tm.tm_hour = hms[0];
+	tm.tm_min = hms[1];
+	tm.tm_sec = hms[2];
+	tm.tm_isdst = -1;
+	sec = std::mktime(&tm);
+	if (sec > now / 1000)
+	{
+		tm.tm_mday--;
+		tm.tm_isdst = -1;
+		sec = std::mktime(&tm);
+	}
+	time = static_cast<std::int64_t>(sec) * 1000;
+	return true;
+}
+
+/**
+ * @brief "board" command, score table at a past time
+ *	board at (HH:MM[:SS] | -<N>[s|m|h])
+ */
+void uc_board()
+{
+	debug_info();
+
+	if (v_exstr.size() != 3 || cmd_code(v_exstr[1]) != SC_AT)
+		report_err("Unknown subcommand", void());
+
+	std::int64_t time;
+	if (!to_past(v_exstr[2], time))
+		report_err("Wrong format of time, expected HH:MM[:SS] or -N[s|m|h]",
+					void());
+
+	scb.print_at(time);
 }
 
+/**
+ * @brief "undo" and "redo" commands, steps of mutations
+ *	undo [<n>]	- reverts the last n steps, 1 by default
+ *	redo [<n>]	- repeats the last n undone steps
+ * @param cmd Code of the command
+ */
+void uc_undo(user_cmnds cmd)
+{
+	debug_info();
+
+	if (v_exstr.size() > 2 || (v_exstr.size() == 2 &&
+		(!is_num_only(v_exstr[1]) || !to_int(v_exstr[1]))))
+		report_err("Unknown subcommand", void());
+
+	unsigned n = v_exstr.size() == 2 ? to_int(v_exstr[1]) : 1;
+	if (cmd == UC_UNDO)
+		scb.undo(n);
+	else
+		scb.redo(n);
+}
+
+/**
+ * @brief "begin", "commit" and "abort" commands, batch of mutations
+ *	begin	- mutations are not ranked, ranks refer to the current ranking
+ *	commit	- ranks all the mutations of the batch at once
+ *	abort	- reverts all the mutations of the batch
+ * @param cmd Code of the command
+ */
+void uc_batch(user_cmnds cmd)
+{
+	debug_info();
+
+	if (v_exstr.size() != 1)
+		report_err("No such subcommand!", void());
+
+	switch(cmd)
+	{
+		case UC_BEGIN:
+			scb.begin_batch();
+			break;
+		case UC_COMMIT:
+			scb.commit_batch();
+			break;
+		default:
+			scb.abort_batch();
+	}
+}
 
 /**
  * @brief Parses command line arguments using getopt
@@ -407,11 +846,76 @@ void parse_args(int argc, char *argv[])
 	s_args.init_plrs = 0; 	// initialize with defaults
 	s_args.max_show = HGHT_LIMIT;
 	s_args.max_plrs = S_PLIMIT;
-	// TODO files
+	s_args.undo_max = UNDO_DEPTH;
+	s_args.sf_path = nullptr;
+	s_args.hf_path = nullptr;
+	s_args.tf_path = nullptr;
+	s_args.snap_every = 0;
+	s_args.jf_path = nullptr;
+	s_args.jrnl_every = 64;
+	s_args.jrnl_ms = 50;
+	s_args.listen_path = nullptr;
+	s_args.ingest_size = 0;
+	s_args.ingest_full = nullptr;
+
+	// "-sf", "-hf", "-tf", "-j*" and "--help" would be taken by getopt as
+	// grouped single char options, they are taken out of argv first
+	int opt_argc = 1;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string opt = argv[i];
+		if (opt == "-sf" || opt == "-hf" || opt == "-tf" || opt == "-jf" ||
+			opt == "-jn" || opt == "-as" ||
+			opt == "-jt" || opt == "--listen" || opt == "--ingest" ||
+			opt == "--ingest-full")
+		{
+			if (i+1 >= argc)
+			{
+				std::cerr << "Error: " << opt << " argument missing" <<
+							std::endl;
+				exit(EXIT_FAILURE);
+			}
+
+			char *arg = argv[++i];
+			if (opt == "-sf")
+				s_args.sf_path = arg;
+			else if (opt == "-hf")
+				s_args.hf_path = arg;
+			else if (opt == "-tf")
+				s_args.tf_path = arg;
+			else if (opt == "-jf")
+				s_args.jf_path = arg;
+			else if (opt == "--listen")
+				s_args.listen_path = arg;
+			else if (opt == "--ingest-full")
+				s_args.ingest_full = arg;
+			else if (!is_num_only(arg))
+			{
+				std::cerr << "Error: " << opt << " argument wrong value" <<
+							std::endl;
+				exit(EXIT_FAILURE);
+			}
+			else if (opt == "--ingest")
+				s_args.ingest_size = std::stoi(arg);
+			else if (opt == "-as")
+				s_args.snap_every = std::stoi(arg);
+			else
+				(opt == "-jn" ? s_args.jrnl_every : s_args.jrnl_ms) = 
+					std::stoi(arg);
+		}
+		else if (opt == "--help")
+		{
+			std::cout << help_usg << std::endl;
+			exit(EXIT_SUCCESS);
+		}
+		else
+			argv[opt_argc++] = argv[i];
+	}
+	argc = opt_argc;
 
 	char c;
 	std::ostringstream aux;		// if optarg is number
-	while ((c = getopt(argc, argv, "p:s:m:f:h")) != -1)
+	while ((c = getopt(argc, argv, "p:s:m:u:f:h")) != -1)
 	{
 		aux.str(std::string());	// clear aux's string part
 		switch(c)
@@ -449,6 +953,17 @@ void parse_args(int argc, char *argv[])
 				}
 				s_args.max_plrs = std::stoi(aux.str());
 				break;
+			case 'u':
+				debug_msg("u arg: " << optarg);
+				aux << optarg;
+				if (!is_num_only(aux.str()))
+				{
+					std::cerr << "Error: -u argument wrong value" << 
+								std::endl;				
+					exit(EXIT_FAILURE);
+				}
+				s_args.undo_max = std::stoi(aux.str());
+				break;
 			case 'f':
 				std::cout << "f arg: " << optarg << std::endl;
 				break;
@@ -460,6 +975,11 @@ void parse_args(int argc, char *argv[])
 				exit(EXIT_FAILURE);
 		}
 	}
+	// restores scoreboard from the journal first, changes are journaled
+	if (s_args.jf_path && !scb.open_journal(s_args.jf_path, 
+							s_args.jrnl_every, s_args.jrnl_ms))
+		exit(EXIT_FAILURE);
+
 	// initializes scoreboard
 	if (s_args.max_show != HGHT_LIMIT)
 		scb.set_show_max(s_args.max_show);
@@ -467,68 +987,255 @@ void parse_args(int argc, char *argv[])
 	if (s_args.max_plrs != S_PLIMIT)
 		scb.set_max_players(s_args.max_plrs);
 
-	if (s_args.init_plrs != 0)
+	if (s_args.undo_max != UNDO_DEPTH)
+		scb.set_undo_depth(s_args.undo_max);
+
+	if (s_args.init_plrs != 0 && scb.player_count())
+		report_war("Players restored from the journal, -p is ignored");
+	else if (s_args.init_plrs != 0)
 		scb.init_players(s_args.init_plrs);
+
+	if (s_args.sf_path)
+		save_path = s_args.sf_path;
+
+	if (s_args.snap_every && !s_args.sf_path)
+	{
+		std::cerr << "Error: -as needs a save file, -sf" << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	if (s_args.snap_every)
+		snaps.set_every(save_path, s_args.snap_every);
+
+	if (s_args.listen_path)
+		listen_path = s_args.listen_path;
+
+	if (s_args.tf_path)
+		table_out.start(s_args.tf_path);
+
+	if (s_args.hf_path)		// snapshot written by "save", or printed table
+	{
+		if (Snap_map::is_snapshot(s_args.hf_path))
+			scb.load_from_file(s_args.hf_path);
+		else
+			scb.load_history(s_args.hf_path);
+	}
+
+	if (s_args.ingest_size || s_args.ingest_full)
+	{
+		std::string_view full = s_args.ingest_full ? s_args.ingest_full :
+														"block";
+		if (full != "block" && full != "drop" && full != "reject")
+		{
+			std::cerr << "Error: --ingest-full argument wrong value" <<
+						std::endl;
+			exit(EXIT_FAILURE);
+		}
+
+		// the prompt may stay idle, the applier reaps and starts snapshots,
+		// the next command reports them
+		ingest.start(s_args.ingest_size ? s_args.ingest_size : INGEST_SIZE,
+					full == "block" ? IF_BLOCK : full == "drop" ? IF_DROP :
+						IF_REJECT, []() { snaps.poll(); });
+	}
 }
 
 /**
- * @brief Main program
+ * @brief Queues a score change by name or id instead of executing it,
+ *	changes by rank are executed right away, a rank is valid only at
+ *	the moment of the command
+ *	win | loss -> <name> | #<id>
+ *	score -> add -> (<name> | #<id>) [<number>]
+ * @param cmd Code of the command
+ * @return True if the command was a score change and it was queued or
+ *	rejected, false if it has to be executed
  */
-int run_scb(int argc, char *argv[])
+static bool queue_score(user_cmnds cmd)
 {
-	// TODO arguments
-	parse_args(argc, argv);
-		
-	// TODO init files
+	std::string_view who;
+	int num;
 
-	// initializes map with strings and codes
-	m_cmd_parse = m_cmd_init();
+	if ((cmd == UC_WIN || cmd == UC_LOSS) && v_exstr.size() == 2)
+	{
+		who = v_exstr[1];
+		num = cmd == UC_WIN ? 1 : -1;
+	}
+	else if (cmd == UC_SCORE && cmd_code(v_exstr[1]) == SC_ADD &&
+			(v_exstr.size() == 3 || (v_exstr.size() == 4 &&
+				is_num_gen(v_exstr[3]))))
+	{
+		who = v_exstr[2];
+		num = v_exstr.size() == 4 ? to_int(v_exstr[3]) : 1;
+	}
+	else
+		return false;
 
-	start_symb();					// prints the starting symbol if OK
-	std::string user_in;
-	while( std::getline (std::cin, user_in) )
+	if (is_num_only(who))		// rank
+		return false;
+
+	Score_event ev;
+	ev.num = num;
+	if (is_id(who))
+	{
+		ev.id = to_id(who);
+		ev.len = 0;
+	}
+	else
 	{
-		split_str(user_in);					// vector of strings
+		ev.id = Pl_id{0};
+		ev.set_name(who);
+	}
+
+	if (!ingest.submit(ev))
+		report_err("Queue of score changes is full, change rejected", true);
+
+	return true;
+}
+
+/**
+ * @brief Records the latency of an executed command
+ * @param cmd Code of the command
+ * @param start Time the command line was taken
+ * @return Code of the command
+ */
+static user_cmnds time_cmd(user_cmnds cmd,
+							std::chrono::steady_clock::time_point start)
+{
+	cmd_stats[cmd - UC_PRINT].add(std::chrono::duration_cast<
+		std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+			.count());
+	return cmd;
+}
+
+/**
+ * @brief Executes one command line
+ * @param line Command line, it is not copied
+ * @return Code of the executed command, UC_NONE if the line is empty or
+ *	the command is unknown, UC_EXIT if the program should end
+ */
+user_cmnds exec_cmd(std::string_view line)
+{
+	auto start = std::chrono::steady_clock::now();
+	user_cmnds cmd;
+	{
+		Stat_scope st(STAT_PARSE);
+		v_exstr.split(line);
 		if (!v_exstr.size())				// only whitespace as an input
-			continue;
+			return UC_NONE;
 
-		switch(m_cmd_parse[v_exstr[0]])		// with only main commands
-		{
-			case UC_PRINT: case UC_SCOREBOARD: case UC_SHOW:
-				uc_print();	
-				break;
-			case UC_SCORE:
-				uc_score();
-				break;
-			case UC_PLAYER:
-				uc_player();
-				break;
-			case UC_WIN:
-				uc_win();
-				break;
-			case UC_LOSS:
-				uc_loss();
-				break;
-			case UC_SET:
-				uc_set();
-				break;
-			case UC_SAVE:
-				uc_save();
-				break;
-			case UC_LOAD:
-				uc_load();
-				break;
-			case UC_HELP:
-				std::cout << help_cmds << std::endl;
-				break;
-			case UC_EXIT:
-				return EXIT_SUCCESS;
-			default:
-				debug_msg("default");
-				std::cerr << "Error: No known command" << std::endl;
-		}
-		start_symb();
+		cmd = cmd_code(v_exstr[0]);
+	}
+
+	// other commands see the queued score changes applied, the applier
+	// does not change the board while they run
+	std::unique_lock<std::mutex> board;
+	if (ingest.running())
+	{
+		if (queue_score(cmd))
+			return time_cmd(cmd, start);
+
+		board = std::unique_lock<std::mutex>(ingest.board());
+		ingest.drain();
+	}
+
+	// board is quiet between the commands, a finished snapshot is reported,
+	// also one reaped by the applier, a periodic one is started
+	snaps.poll();
+	snaps.report();
+
+	switch(cmd)		// with only main commands
+	{
+		case UC_PRINT: case UC_SCOREBOARD: case UC_SHOW:
+			uc_print();	
+			break;
+		case UC_SCORE:
+			uc_score();
+			break;
+		case UC_PLAYER:
+			uc_player();
+			break;
+		case UC_WIN:
+			uc_win();
+			break;
+		case UC_LOSS:
+			uc_loss();
+			break;
+		case UC_SET:
+			uc_set();
+			break;
+		case UC_SAVE:
+			uc_save();
+			break;
+		case UC_LOAD:
+			uc_load();
+			break;
+		case UC_HELP:
+			std::cout << help_cmds << std::endl;
+			break;
+		case UC_BEGIN: case UC_COMMIT: case UC_ABORT:
+			uc_batch(cmd);
+			break;
+		case UC_COMPACT:
+			if (v_exstr.size() != 1)
+				std::cerr << "<Error>: No such subcommand!" << std::endl;
+			else
+				scb.compact();
+			break;
+		case UC_FIND: case UC_COMPLETE:
+			uc_find(cmd);
+			break;
+		case UC_HISTORY:
+			uc_history();
+			break;
+		case UC_BOARD:
+			uc_board();
+			break;
+		case UC_UNDO: case UC_REDO:
+			uc_undo(cmd);
+			break;
+		case UC_SNAPSHOT:
+			uc_snapshot();
+			break;
+		case UC_STATS:
+			uc_stats();
+			break;
+		case UC_EXIT:
+			break;
+		default:
+			debug_msg("default");
+			std::cerr << "Error: No known command" << std::endl;
+			return UC_NONE;
+	}
+
+	if (table_out.running())		// written by its thread if the board changed
+		table_out.notify();
+
+	return time_cmd(cmd, start);
+}
+
+/**
+ * @brief Main program
+ */
+int run_scb(int argc, char *argv[])
+{
+	parse_args(argc, argv);
+
+	int ret = EXIT_SUCCESS;
+	if (!listen_path.empty())		// commands come from the socket clients
+	{
+		Scb_server server;
+		ret = server.open(listen_path) ? server.run() : EXIT_FAILURE;
+	}
+	else
+	{
+		start_symb();				// prints the starting symbol if OK
+		std::string user_in;		// keeps its capacity between the lines
+		while (std::getline(std::cin, user_in) && 
+				exec_cmd(user_in) != UC_EXIT)
+			start_symb();
 	}
 
-	return EXIT_SUCCESS;	// TODO
+	ingest.stop();					// queued changes are applied
+	table_out.stop();				// last state of the board is written
+	snaps.wait();					// running snapshot is reported
+	return ret;
 }
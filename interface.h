@@ -9,11 +9,17 @@
 #ifndef INTERFACE_H
 #define INTERFACE_H
 
+#include <string_view>
+
+const unsigned CMD_MAX_TOKENS = 8;	///< Longest command has 4 words
+
 /**
  * @brief Numeric constants for user commands
  */
 enum user_cmnds
 {
+	UC_NONE = 0,		///< Not a keyword, or an empty line
+
 	// user commands
 	UC_PRINT = 550,
 	UC_SCOREBOARD,
@@ -27,6 +33,18 @@ enum user_cmnds
 	UC_LOAD,
 	UC_HELP,
 	UC_EXIT,
+	UC_BEGIN,
+	UC_COMMIT,
+	UC_ABORT,
+	UC_COMPACT,
+	UC_FIND,
+	UC_COMPLETE,
+	UC_HISTORY,
+	UC_BOARD,
+	UC_UNDO,
+	UC_REDO,
+	UC_SNAPSHOT,
+	UC_STATS,
 
 	// subcommands
 	SC_ADD,
@@ -35,44 +53,83 @@ enum user_cmnds
 	SC_RESET,
 	SC_MAX,
 	SC_FILE,
-	SC_HISTORY,
+	SC_AT,
 	SC_PLAYERS,
-	SC_ALL
+	SC_ALL,
+	SC_ID
 };
 
 // help message usage
 const char *const help_usg =
- "Usage: ./scoreboard [-p P] [-s S] [-m M] [-sf file] [-hf histFile] [-h] "
- "[--help]\n"
+ "Usage: ./scoreboard [-p P] [-s S] [-m M] [-u U] [-sf file] [-hf histFile]"
+ "\n       [-as T] [-tf file] [-jf journal [-jn N] [-jt T]]\n"
+ "       [--listen socket] [--ingest N [--ingest-full block|drop|reject]]\n"
+ "       [-h] [--help]\n"
  "Options: \n"
  " -p P      Initialzes scoreboard with P players, where P is the number\n"
  "           of players, max being a set limit of players\n"
  " -s S      Sets S players that will be shown when score table is print\n"
  " -m M      Sets maximum number of players (Player limit)\n"
- " -sf file  Sets a file path to a save file, scoreboard will now print \n"
- "           to a file instead of STDOUT\n"
- " -hf file  Sets a path to a history file with printed scoreboard, data\n"
- "           will load into the current scoreboard\n"
+ " -u U      Sets U changes that can be undone, 0 disables undo (64)\n"
+ " -sf file  Sets a file path to a save file, used by \"save\" without\n"
+ "           a path\n"
+ " -hf file  Sets a path to a history file with printed scoreboard or a\n"
+ "           save file, data will load into the current scoreboard\n"
+ " -as T     Writes a snapshot to the save file every T seconds, if the\n"
+ "           board changed, in the background\n"
+ " -tf file  Keeps the score table in the file, rewritten in the\n"
+ "           background after changes, always replaced as a whole\n"
+ " -jf file  Sets a path to a journal, every change of the scoreboard\n"
+ "           is appended to it, on start the scoreboard is restored from\n"
+ "           the journal and its snapshot \"file.snap\"\n"
+ " -jn N     Journal is synchronized to the disk after N changes (64)\n"
+ " -jt T     Journal is synchronized to the disk at least every T ms (50)\n"
+ " --listen socket\n"
+ "           Serves the commands over a Unix domain socket instead of\n"
+ "           the standard input, every reply ends with a line OK or ERR\n"
+ " --ingest N\n"
+ "           Score changes by name or id (win, loss, score add) are\n"
+ "           queued for N events and applied in batches by another thread\n"
+ " --ingest-full block|drop|reject\n"
+ "           When the queue is full, wait, lose the event, or refuse it\n"
+ "           with an error (block)\n"
  " -h|--help Shows this message.\n";
 
 // help message - commands
 const char *const help_cmds = 
  "print | scoreboard | show | score\t- show current score table\n"
  "player\t-> add [<name>] [<score>]\n"
- "\t-> remove ( all | ( <name> | <rank> ) )\n"
- "\t-> rename (<name> | <rank>) <new_name>\n"
- "score\t-> add (<name> | <rank>) [<number>]\n"
- "\t-> reset ( all  (<name> | <rank>) )\n"
- "win\t-> <name> | <rank>\n"
- "loss\t-> <name> | <rank>\n"
+ "\t-> remove ( all | ( <name> | <rank> | #<id> ) )\n"
+ "\t-> rename (<name> | <rank> | #<id>) <new_name>\n"
+ "\t-> id (<name> | <rank>)\t- shows the id of a player\n"
+ "score\t-> add (<name> | <rank> | #<id>) [<number>]\n"
+ "\t-> reset ( all  (<name> | <rank> | #<id>) )\n"
+ "win\t-> <name> | <rank> | #<id>\n"
+ "loss\t-> <name> | <rank> | #<id>\n"
  "set\t-> show <SHOW_PLAYERS>\n"
  "\t-> plimit <MAX_PLAYERS>\n"
  "\t-> file <path_to_file_for_saving>\n"
- "save\t-> // nothing if save file path specified\n"
- "\t-> file <path_to_file_to_save>\n"
+ "\t-> undo <UNDO_STEPS>\n"
+ "\t-> snapshot <SECONDS>\t- periodic snapshots to the save file, 0 none\n"
+ "save\t-> // to the save file path if specified\n"
+ "\t-> [file] <path_to_file_to_save>\n"
  "\t-> history <path_to_save_history_file>\n"
- "load\t-> history <path_to_history_file>\n"
+ "snapshot -> [<path>]\t- same as save, written in the background\n"
+ "load\t-> [file] <path_to_saved_file>\n"
+ "\t-> history <path_to_history_file>\n"
  "\t-> players <path_to_players_name_file>\n"
+ "begin\t- starts a batch, ranking is updated only on commit\n"
+ "commit\t- ends the batch and updates the ranking\n"
+ "abort\t- ends the batch and reverts its changes\n"
+ "undo\t-> [<n>]\t- reverts the last n changes, a batch is one change\n"
+ "redo\t-> [<n>]\t- repeats the last n undone changes\n"
+ "compact\t- folds the journal into its snapshot\n"
+ "find\t-> <prefix> | <pattern>\t- players by name, ? any char, % any chars\n"
+ "complete -> <prefix>\t- completes a player name\n"
+ "history\t-> <name> | <rank> | #<id>\t- past score changes of a player\n"
+ "board\t-> at (HH:MM[:SS] | -<N>[s|m|h])\t- score table at a past time\n"
+ "stats\t- show latencies of commands and their phases\n"
+ "\t-> reset\n"
  "help\t- show this message\n"
  "exit\t- shuts down the scoreboard app\n";
 
@@ -84,11 +141,38 @@ struct Args
 	int init_plrs;	///< Number of initial players
 	int max_show;	///< Number of maximum shown players
 	int max_plrs;	///< Player limit
+	int undo_max;	///< Steps kept for undo
 	char *sf_path;	///< Path to a save file
 	char *hf_path;	///< Path to a history file
+	char *tf_path;	///< Path to a table file
+	int snap_every;	///< Seconds between snapshots, 0 none
+	char *jf_path;	///< Path to a journal
+	int jrnl_every;	///< Journal synchronized after this many changes
+	int jrnl_ms;	///< Journal synchronized at least every ms
+	char *listen_path;	///< Socket path of the server mode
+	int ingest_size;	///< Capacity of the queue of score events, 0 none
+	char *ingest_full;	///< Policy of the full queue
+};
+
+/**
+ * @brief Words of a command line, views into the line, so splitting it
+ *	does not allocate, words over CMD_MAX_TOKENS are only counted
+ */
+class Cmd_tokens
+{
+		std::string_view tok[CMD_MAX_TOKENS];	///< Words
+		unsigned cnt = 0;						///< Number of words
+	public:
+		void split(std::string_view line);
+		unsigned size() const { return cnt; }
+		std::string_view operator[](unsigned i) const
+		{
+			return i < CMD_MAX_TOKENS ? tok[i] : std::string_view();
+		}
 };
 
 int run_scb(int argc, char *argv[]);
+user_cmnds exec_cmd(std::string_view line);
 void parse_args(int argc, char *argv[]);
 
 inline void start_symb();
@@ -102,6 +186,13 @@ void uc_loss();
 void uc_set();
 void uc_save();
 void uc_load();
+void uc_batch(user_cmnds cmd);
+void uc_find(user_cmnds cmd);
+void uc_history();
+void uc_board();
+void uc_undo(user_cmnds cmd);
+void uc_snapshot();
+void uc_stats();
 
 // user subcommands
 void sc_add_sc();
@@ -110,6 +201,7 @@ void sc_reset();
 void sc_add_p();
 void sc_remove();
 void sc_rename();
+void sc_id();
 
 
 #endif
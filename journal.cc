@@ -0,0 +1,312 @@
+/**
+ * @file journal.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the journal of scoreboard mutations
+ */
+
+#include "journal.h"
+#include "scoreboard.h"
+#include "stats.h"
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>		// open
+#include <sys/mman.h>	// mmap
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char JRNL_MAGIC[4] = {'S', 'C', 'B', 'J'};
+const std::size_t JRNL_HEADER = 8;		// magic, generation
+const std::size_t JRNL_NAME = 120;		// longest journaled name
+
+
+/**
+ * @brief Fletcher-16 checksum of a record payload
+ */
+static std::uint16_t rec_checksum(const unsigned char *data, std::size_t len)
+{
+	unsigned a = 0, b = 0;
+	for (std::size_t i = 0; i < len; i++)
+	{
+		a = (a + data[i]) % 255;
+		b = (b + a) % 255;
+	}
+
+	return (b << 8) | a;
+}
+
+/**
+ * @brief Reads all valid records of a journal file, stops at the first
+ *	incomplete or damaged record, which is a write interrupted by a crash
+ * @param path Path of the journal file
+ * @param gen Output, generation of the journal, 0 if there is no journal
+ * @param valid Output, length of the valid part of the file
+ * @param func Called for each record, names are valid only in the call
+ * @return False if the file cannot be read or is not a journal
+ */
+bool Journal::read(const std::string &path, std::uint32_t &gen,
+					std::size_t &valid,
+					const std::function<void(const Record &)> &func)
+{
+	debug_info();
+
+	gen = 0;
+	valid = 0;
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		if (errno == ENOENT)		// new journal
+			return true;
+		report_err("Cannot open journal " << path << ": " <<
+					std::strerror(errno), false);
+	}
+
+	struct stat st;
+	if (::fstat(fd, &st))
+	{
+		::close(fd);
+		report_err("Cannot read journal " << path, false);
+	}
+
+	std::size_t len = st.st_size;
+	if (len < JRNL_HEADER)		// empty or not even the header written
+	{
+		::close(fd);
+		return true;
+	}
+
+	void *addr = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (addr == MAP_FAILED)
+		report_err("Cannot map journal " << path << ": " <<
+					std::strerror(errno), false);
+
+	const unsigned char *data = static_cast<const unsigned char *>(addr);
+	if (std::memcmp(data, JRNL_MAGIC, sizeof(JRNL_MAGIC)))
+	{
+		::munmap(addr, len);
+		report_err("File " << path << " is not a journal", false);
+	}
+	std::memcpy(&gen, data + 4, 4);
+
+	std::size_t pos = JRNL_HEADER;
+	while (pos < len)
+	{
+		std::size_t rec_len = data[pos];
+		if (pos + 1 + rec_len + 2 > len || rec_len < 7)
+			break;
+
+		const unsigned char *p = data + pos + 1;
+		std::uint16_t check;
+		std::memcpy(&check, p + rec_len, 2);
+		if (check != rec_checksum(p, rec_len))
+			break;
+
+		Record rec;
+		rec.op = static_cast<Op>(p[0]);
+		std::memcpy(&rec.num, p + 1, 4);
+
+		std::size_t n1 = p[5];
+		if (6 + n1 + 1 > rec_len || 6 + n1 + 1 + p[6 + n1] != rec_len)
+			break;
+		rec.name = std::string_view(reinterpret_cast<const char *>(p + 6),
+									n1);
+		rec.name2 = std::string_view(
+			reinterpret_cast<const char *>(p + 7 + n1), p[6 + n1]);
+
+		func(rec);
+		pos += 1 + rec_len + 2;
+	}
+
+	if (pos < len)
+		report_war("Journal " << path << " has an incomplete record at " <<
+					"offset " << pos << ", it is dropped");
+
+	valid = pos;
+	::munmap(addr, len);
+	return true;
+}
+
+/**
+ * @brief Opens a journal for appending
+ * @param path Path of the journal file
+ * @param valid Length of the valid part of the file, the rest is cut off
+ * @param generation Generation of a new journal
+ * @param every Synchronize after this many records, 0 never
+ * @param ms Synchronize at least every ms milliseconds, 0 never
+ * @return True on success
+ */
+bool Journal::open(const std::string &path, std::size_t valid,
+					std::uint32_t generation, unsigned every, unsigned ms)
+{
+	debug_info();
+
+	close();
+
+	fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+	if (fd < 0)
+		report_err("Cannot open journal " << path << ": " <<
+					std::strerror(errno), false);
+
+	this->path = path;
+	sync_every = every;
+	sync_ms = ms;
+	pending = 0;
+
+	if (valid < JRNL_HEADER)
+	{
+		if (!reset(generation))
+		{
+			close();
+			return false;
+		}
+	}
+	else if (::ftruncate(fd, valid))
+	{
+		close();
+		report_err("Cannot truncate journal " << path, false);
+	}
+	else
+		gen = generation;
+
+	if (sync_ms)
+	{
+		stop = false;
+		flusher = std::thread(&Journal::flush_loop, this);
+	}
+
+	return true;
+}
+
+/**
+ * @brief Synchronizes and closes the journal
+ */
+void Journal::close()
+{
+	if (flusher.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			stop = true;
+		}
+		cv.notify_one();
+		flusher.join();
+	}
+
+	if (fd < 0)
+		return;
+
+	sync();
+	::close(fd);
+	fd = -1;
+}
+
+/**
+ * @brief Appends a record, writes it right away, so it survives a crash
+ *	of the program, but synchronizes it to the disk in groups
+ * @param op Operation
+ * @param name Player name
+ * @param num Score or limit
+ * @param name2 New name of the player
+ */
+void Journal::append(Op op, std::string_view name, std::int32_t num,
+						std::string_view name2)
+{
+	if (fd < 0)
+		return;
+
+	Stat_scope st(STAT_JOURNAL);
+	name = name.substr(0, JRNL_NAME);
+	name2 = name2.substr(0, JRNL_NAME);
+
+	unsigned char rec[1 + 7 + 2*JRNL_NAME + 2];
+	unsigned char *p = rec + 1;
+	std::size_t len = 7 + name.size() + name2.size();
+
+	rec[0] = len;
+	p[0] = op;
+	std::memcpy(p + 1, &num, 4);
+	p[5] = name.size();
+	std::memcpy(p + 6, name.data(), name.size());
+	p[6 + name.size()] = name2.size();
+	std::memcpy(p + 7 + name.size(), name2.data(), name2.size());
+
+	std::uint16_t check = rec_checksum(p, len);
+	std::memcpy(p + len, &check, 2);
+
+	if (!write_all(reinterpret_cast<char *>(rec), 1 + len + 2))
+		return;
+
+	if (sync_every && ++pending >= sync_every)
+		sync();
+}
+
+/**
+ * @brief Synchronizes written records to the disk
+ */
+void Journal::sync()
+{
+	if (fd >= 0 && pending.exchange(0))
+	{
+		::fdatasync(fd);
+		scb_stats.count(STAT_SYNCS);
+	}
+}
+
+/**
+ * @brief Empties the journal, used when its records are saved elsewhere
+ * @param new_gen Generation of the emptied journal
+ * @return True on success
+ */
+bool Journal::reset(std::uint32_t new_gen)
+{
+	debug_info();
+
+	char hdr[JRNL_HEADER];
+	std::memcpy(hdr, JRNL_MAGIC, sizeof(JRNL_MAGIC));
+	std::memcpy(hdr + 4, &new_gen, 4);
+
+	if (::ftruncate(fd, 0) || !write_all(hdr, sizeof(hdr)) ||
+		::fdatasync(fd))
+		report_err("Cannot reset journal " << path, false);
+
+	gen = new_gen;
+	pending = 0;
+	return true;
+}
+
+/**
+ * @brief Writes the whole buffer to the journal
+ * @return True on success
+ */
+bool Journal::write_all(const char *data, std::size_t len)
+{
+	while (len)
+	{
+		ssize_t n = ::write(fd, data, len);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0)
+			report_err("Cannot write journal " << path << ": " <<
+						std::strerror(errno), false);
+		data += n;
+		len -= n;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Flusher thread, synchronizes pending records every sync_ms
+ */
+void Journal::flush_loop()
+{
+	std::unique_lock<std::mutex> lock(mtx);
+	while (!stop)
+	{
+		cv.wait_for(lock, std::chrono::milliseconds(sync_ms));
+		sync();
+	}
+}
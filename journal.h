@@ -0,0 +1,103 @@
+/**
+ * @file journal.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Append-only journal of the scoreboard mutations
+ *	Layout: header (magic "SCBJ", generation), then records:
+ *	length (1 B), payload, checksum of the payload (2 B).
+ *	Payload: operation (1 B), number (4 B), name length (1 B), name,
+ *	second name length (1 B), second name. Host byte order.
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+/**
+ * @brief Journal of mutations, every record is written right away and
+ *	the file is synchronized to the disk in groups, after a number of
+ *	records or a period of time, whichever comes first
+ */
+class Journal
+{
+	public:
+		/**
+		 * @brief Journaled operations, names and numbers are always the
+		 *	resolved ones, so the replay does not depend on the ranking
+		 */
+		enum Op : std::uint8_t
+		{
+			J_ADD = 1,		///< name, score
+			J_REMOVE,		///< name
+			J_RENAME,		///< name, new name
+			J_SCORE,		///< name, new score
+			J_RESET_ALL,	///< -
+			J_REMOVE_ALL,	///< -
+			J_LIMIT,		///< player limit
+			J_SHOW,			///< number of shown players
+			J_BEGIN,		///< -
+			J_COMMIT,		///< -
+			J_ABORT,		///< -
+			J_RESTORE		///< name, score, id in decimal as second name
+		};
+
+		/**
+		 * @brief Decoded record, names point to the journal file
+		 */
+		struct Record
+		{
+			Op op;
+			std::int32_t num;
+			std::string_view name;
+			std::string_view name2;
+		};
+	private:
+		int fd;							///< Journal file, -1 if closed
+		std::string path;				///< Path of the journal file
+		std::uint32_t gen;				///< Generation of the journal
+		unsigned sync_every;			///< Records per synchronization
+		unsigned sync_ms;				///< Max. time between synchronizations
+		std::atomic<unsigned> pending;	///< Records not synchronized yet
+
+		std::thread flusher;			///< Synchronizes every sync_ms
+		std::mutex mtx;					///< Guards stop
+		std::condition_variable cv;		///< Wakes up the flusher to stop
+		bool stop;						///< Flusher has to end
+	public:
+		Journal(): fd{-1}, gen{0}, sync_every{1}, sync_ms{0}, pending{0},
+					stop{false} {}
+		Journal(const Journal &) = delete;
+		Journal &operator=(const Journal &) = delete;
+
+		static bool read(const std::string &path, std::uint32_t &gen,
+						std::size_t &valid,
+						const std::function<void(const Record &)> &func);
+
+		bool open(const std::string &path, std::size_t valid,
+					std::uint32_t gen, unsigned every, unsigned ms);
+		void close();
+		bool is_open() const { return fd >= 0; }
+
+		void append(Op op, std::string_view name = {}, std::int32_t num = 0,
+					std::string_view name2 = {});
+		void sync();
+		bool reset(std::uint32_t new_gen);
+
+		std::uint32_t generation() const { return gen; }
+		const std::string &get_path() const { return path; }
+
+		~Journal() { close(); }
+	private:
+		bool write_all(const char *data, std::size_t len);
+		void flush_loop();
+};
+
+#endif	// include JOURNAL_H
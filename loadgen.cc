@@ -0,0 +1,541 @@
+/**
+ * @file loadgen.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Load generator, a tournament like stream of commands is executed
+ *	by the same dispatch as the interactive scoreboard (exec_cmd), or sent
+ *	to a scoreboard server (--listen) by many pipelining clients
+ *	Usage: ./scb_loadgen [-n N] [-p P] [-r R] [-z Z] [-w W] [-s S]
+ *						[-u socket [-c C] [-d D]]
+ *	Players are picked with Zipf distribution, the stream depends only on
+ *	the options, its hash is printed so runs can be compared. Commands of
+ *	one player are always sent by the same client, so they stay in order.
+ */
+
+#include "scoreboard.h"
+#include "interface.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <streambuf>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>		// getopt
+#include <vector>
+
+/**
+ * @brief Kinds of generated commands, the order of the report
+ */
+enum Load_cmd
+{
+	LC_ADD,			///< player add <name> 0
+	LC_WIN,			///< win <name>
+	LC_LOSS,		///< loss <name>
+	LC_SCORE,		///< score add <name> <number>
+	LC_RENAME,		///< player rename <name> <new_name>
+	LC_PRINT,		///< print
+	LC_COUNT
+};
+
+const char *const load_names[LC_COUNT] =
+	{"player_add", "win", "loss", "score_add", "rename", "print"};
+
+/// Shares of the writing commands in thousandths
+const unsigned load_mix[LC_PRINT] = {10, 380, 380, 170, 60};
+
+const char *const load_usg =
+ "Usage: ./scb_loadgen [-n N] [-p P] [-r R] [-z Z] [-w W] [-s S]\n"
+ "                     [-u socket [-c C] [-d D]]\n"
+ " -n N  Number of generated commands (200000)\n"
+ " -p P  Number of players at the start (1000)\n"
+ " -r R  Percentage of reading commands, print (5)\n"
+ " -z Z  Exponent of the Zipf distribution of players (1.0)\n"
+ " -w W  Number of shown players (10)\n"
+ " -s S  Seed of the generator (1)\n"
+ " -u U  Commands are sent to the scoreboard server listening on U\n"
+ " -c C  Number of clients of the server (16)\n"
+ " -d D  Commands sent by a client before it waits for replies (8)\n";
+
+/**
+ * @brief Options of the load
+ */
+struct Load_args
+{
+	unsigned long cmds = 200000;	///< Number of commands
+	unsigned players = 1000;		///< Initial players
+	unsigned reads = 5;				///< Percentage of reads
+	double zipf = 1.0;				///< Zipf exponent
+	unsigned show = 10;				///< Shown players
+	std::uint64_t seed = 1;			///< Seed
+	const char *sock = nullptr;		///< Socket of the server
+	unsigned clients = 16;			///< Clients of the server
+	unsigned depth = 8;				///< Pipelined commands of a client
+};
+
+/**
+ * @brief Stream buffer discarding everything, output of the commands is
+ *	not measured
+ */
+class Null_buf : public std::streambuf
+{
+	protected:
+		int_type overflow(int_type c) override
+		{
+			return traits_type::not_eof(c);
+		}
+		std::streamsize xsputn(const char *, std::streamsize n) override
+		{
+			return n;
+		}
+};
+
+/**
+ * @brief Pseudo random numbers (splitmix64), the distributions of the
+ *	standard library differ between implementations, so they are not used
+ */
+class Load_rand
+{
+		std::uint64_t state;
+	public:
+		explicit Load_rand(std::uint64_t seed): state{seed} {}
+		std::uint64_t next()
+		{
+			std::uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+			return z ^ (z >> 31);
+		}
+		double uniform() { return (next() >> 11) * 0x1.0p-53; }	///< [0, 1)
+		unsigned below(unsigned bound) { return next() % bound; }
+};
+
+/**
+ * @brief Zipf distribution over 0 .. n-1, index 0 is the most popular
+ */
+class Zipf
+{
+		std::vector<double> cdf;
+	public:
+		Zipf(unsigned n, double s);
+		unsigned pick(Load_rand &rnd) const
+		{
+			return std::upper_bound(cdf.begin(), cdf.end(),
+									rnd.uniform() * cdf.back()) - cdf.begin();
+		}
+};
+
+/**
+ * @brief Builds the cumulative distribution
+ * @param n Number of items
+ * @param s Exponent, 0 is uniform
+ */
+Zipf::Zipf(unsigned n, double s)
+{
+	double sum = 0;
+	cdf.reserve(n);
+	for (unsigned k = 1; k <= n; k++)
+	{
+		sum += 1.0 / std::pow(k, s);
+		cdf.push_back(sum);
+	}
+}
+
+/**
+ * @brief Generates the command stream
+ * @param args Options
+ * @param kinds Output, kind of each command
+ * @param owners Output, player of each command, or index of the command
+ *	if it has no existing player
+ * @return Command lines
+ */
+static std::vector<std::string> gen_stream(const Load_args &args,
+											std::vector<Load_cmd> &kinds,
+											std::vector<unsigned> &owners)
+{
+	Load_rand rnd(args.seed);
+	Zipf zipf(args.players, args.zipf);
+	std::vector<std::string> names;		// current names of the players
+	std::vector<unsigned> renames;		// times each player was renamed
+	std::vector<std::string> lines;
+
+	for (unsigned i = 0; i < args.players; i++)
+		names.push_back("p" + std::to_string(i));
+	renames.assign(args.players, 0);
+
+	lines.reserve(args.cmds);
+	kinds.reserve(args.cmds);
+	for (unsigned long i = 0; i < args.cmds; i++)
+	{
+		Load_cmd kind = LC_PRINT;
+		if (rnd.below(100) >= args.reads)
+		{
+			unsigned r = rnd.below(1000);
+			int k = LC_ADD;
+			while (r >= load_mix[k])		// the shares sum up to 1000
+				r -= load_mix[k++];
+			kind = static_cast<Load_cmd>(k);
+		}
+
+		unsigned who = zipf.pick(rnd);
+		switch (kind)
+		{
+			case LC_ADD:
+				if (names.size() >= H_PLIMIT)
+				{
+					kind = LC_PRINT;
+					lines.push_back("print");
+					break;
+				}
+				names.push_back("p" + std::to_string(names.size()));
+				lines.push_back("player add " + names.back() + " 0");
+				break;
+			case LC_WIN:
+				lines.push_back("win " + names[who]);
+				break;
+			case LC_LOSS:
+				lines.push_back("loss " + names[who]);
+				break;
+			case LC_SCORE:
+				lines.push_back("score add " + names[who] + " " +
+								std::to_string(static_cast<int>(
+									rnd.below(21)) - 10));
+				break;
+			case LC_RENAME:
+			{
+				std::string old_name = names[who];
+				names[who] = "p" + std::to_string(who) + "_" +
+								std::to_string(++renames[who]);
+				lines.push_back("player rename " + old_name + " " +
+								names[who]);
+				break;
+			}
+			default:
+				lines.push_back("print");
+		}
+		kinds.push_back(kind);
+		owners.push_back(kind == LC_ADD || kind == LC_PRINT ? i : who);
+	}
+
+	return lines;
+}
+
+/**
+ * @brief Percentile of sorted samples, nearest rank
+ */
+static long long percentile(const std::vector<long long> &v, double p)
+{
+	if (v.empty())
+		return 0;
+
+	std::size_t at = static_cast<std::size_t>(std::ceil(p * v.size()));
+	return v[std::min(v.size(), std::max<std::size_t>(at, 1)) - 1];
+}
+
+/**
+ * @brief Parses the options
+ * @return False if they are not valid
+ */
+static bool parse_load_args(int argc, char *argv[], Load_args &args)
+{
+	int c;
+	while ((c = getopt(argc, argv, "n:p:r:z:w:s:u:c:d:")) != -1)
+	{
+		char *end = nullptr;
+		switch (c)
+		{
+			case 'u': args.sock = optarg; end = optarg + std::strlen(optarg);
+				break;
+			case 'c': args.clients = std::strtoul(optarg, &end, 10); break;
+			case 'd': args.depth = std::strtoul(optarg, &end, 10); break;
+			case 'n': args.cmds = std::strtoul(optarg, &end, 10); break;
+			case 'p': args.players = std::strtoul(optarg, &end, 10); break;
+			case 'r': args.reads = std::strtoul(optarg, &end, 10); break;
+			case 'z': args.zipf = std::strtod(optarg, &end); break;
+			case 'w': args.show = std::strtoul(optarg, &end, 10); break;
+			case 's': args.seed = std::strtoull(optarg, &end, 10); break;
+			default: return false;
+		}
+		if (!end || *end)
+			return false;
+	}
+
+	return optind == argc && args.cmds && args.players &&
+			args.players <= H_PLIMIT && args.reads <= 100 && args.zipf >= 0 &&
+			args.clients && args.depth;
+}
+
+/**
+ * @brief Client of the scoreboard server, sends its commands in order,
+ *	at most depth of them wait for the replies at once
+ */
+struct Load_conn
+{
+	int fd = -1;
+	std::vector<std::size_t> cmds;	///< Indexes of the commands to send
+	std::size_t sent = 0;			///< Sent commands
+	std::size_t done = 0;			///< Replied commands
+	std::string out;				///< Unsent requests
+	std::size_t out_at = 0;			///< Sent part of out
+	std::string in;					///< Incomplete reply line
+};
+
+/**
+ * @brief Connects to the server
+ * @param path Path of the socket
+ * @return Non blocking socket, -1 on error
+ */
+static int load_connect(const char *path)
+{
+	sockaddr_un addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	std::strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&addr),
+							sizeof(addr)))
+	{
+		std::perror(path);
+		if (fd >= 0)
+			close(fd);
+		return -1;
+	}
+
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+	return fd;
+}
+
+/**
+ * @brief Runs the commands on the clients until all are replied, a reply
+ *	ends with a line "OK" or "ERR"
+ * @param conns Connected clients with their commands
+ * @param lines Command lines
+ * @param depth Commands sent before waiting for replies
+ * @param lat Output, latency of each command from its sending in ns
+ * @param errors Output, number of "ERR" replies
+ * @return False if a connection failed
+ */
+static bool run_conns(std::vector<Load_conn> &conns,
+						const std::vector<std::string> &lines, unsigned depth,
+						std::vector<long long> &lat, unsigned long &errors)
+{
+	using clock = std::chrono::steady_clock;
+	std::vector<clock::time_point> sent_at(lines.size());
+	std::vector<pollfd> pfds(conns.size());
+	std::size_t left = 0;
+	char buf[1u << 16];
+
+	lat.assign(lines.size(), 0);
+	for (const Load_conn &c : conns)
+		left += c.cmds.size();
+
+	while (left)
+	{
+		for (std::size_t i = 0; i < conns.size(); i++)
+		{
+			Load_conn &c = conns[i];
+			clock::time_point now = clock::now();
+			while (c.sent < c.cmds.size() && c.sent - c.done < depth)
+			{
+				std::size_t cmd = c.cmds[c.sent++];
+				c.out += lines[cmd];
+				c.out += '\n';
+				sent_at[cmd] = now;
+			}
+
+			while (c.out_at < c.out.size())
+			{
+				ssize_t n = send(c.fd, c.out.data() + c.out_at,
+									c.out.size() - c.out_at, MSG_NOSIGNAL);
+				if (n < 0 && errno == EAGAIN)
+					break;
+				if (n < 0)
+					return false;
+				c.out_at += n;
+			}
+			if (c.out_at == c.out.size())
+			{
+				c.out.clear();
+				c.out_at = 0;
+			}
+
+			pfds[i].fd = c.done < c.cmds.size() ? c.fd : -1;
+			pfds[i].events = POLLIN | (c.out.empty() ? 0 : POLLOUT);
+			pfds[i].revents = 0;
+		}
+
+		if (poll(pfds.data(), pfds.size(), -1) < 0 && errno != EINTR)
+			return false;
+
+		for (std::size_t i = 0; i < conns.size(); i++)
+		{
+			Load_conn &c = conns[i];
+			if (!(pfds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+				continue;
+
+			ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+			if (n <= 0 && errno != EAGAIN)
+				return false;
+
+			clock::time_point now = clock::now();
+			c.in.append(buf, std::max<ssize_t>(n, 0));
+			std::size_t start = 0, nl;
+			while ((nl = c.in.find('\n', start)) != std::string::npos)
+			{
+				std::string_view line(c.in.data() + start, nl - start);
+				start = nl + 1;
+				if (line != "OK" && line != "ERR")
+					continue;
+
+				std::size_t cmd = c.cmds[c.done++];
+				lat[cmd] = std::chrono::duration_cast<
+					std::chrono::nanoseconds>(now - sent_at[cmd]).count();
+				errors += line == "ERR";
+				left--;
+			}
+			c.in.erase(0, start);
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Sends the stream to the server, players are set up first by one
+ *	client, then the stream is split among the clients by players
+ * @param args Options
+ * @param lines Command lines
+ * @param owners Player of each command
+ * @param lat Output, latencies of the commands of the stream
+ * @param secs Output, duration of the stream
+ * @return False if the server cannot be used
+ */
+static bool run_remote(const Load_args &args,
+						const std::vector<std::string> &lines,
+						const std::vector<unsigned> &owners,
+						std::vector<long long> &lat, double &secs)
+{
+	std::vector<Load_conn> conns(args.clients);
+	for (Load_conn &c : conns)
+		if ((c.fd = load_connect(args.sock)) < 0)
+			return false;
+
+	std::vector<std::string> setup = {"player remove all",
+		"set plimit 65535", "set show " + std::to_string(args.show)};
+	Load_rand rnd(args.seed);
+	for (unsigned i = 0; i < args.players; i++)
+		setup.push_back("player add p" + std::to_string(i) + " " +
+						std::to_string(static_cast<int>(rnd.below(201)) - 100));
+
+	std::vector<Load_conn> first(1);
+	std::vector<long long> setup_lat;
+	unsigned long errors = 0;
+	first[0].fd = conns[0].fd;
+	for (std::size_t i = 0; i < setup.size(); i++)
+		first[0].cmds.push_back(i);
+	if (!run_conns(first, setup, 64, setup_lat, errors))
+		return false;
+
+	for (std::size_t i = 0; i < lines.size(); i++)
+		conns[owners[i] % args.clients].cmds.push_back(i);
+
+	errors = 0;
+	auto start = std::chrono::steady_clock::now();
+	bool ok = run_conns(conns, lines, args.depth, lat, errors);
+	secs = std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start).count();
+
+	for (Load_conn &c : conns)
+		close(c.fd);
+
+	if (!ok)
+		std::fprintf(stderr, "Connection to the server failed\n");
+	std::printf("# errors\t%lu\n", errors);
+	return ok;
+}
+
+/**
+ * @brief Runs the load and reports the latencies
+ */
+int main(int argc, char *argv[])
+{
+	Load_args args;
+	if (!parse_load_args(argc, argv, args))
+	{
+		std::cerr << load_usg;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<Load_cmd> kinds;
+	std::vector<unsigned> owners;
+	std::vector<std::string> lines = gen_stream(args, kinds, owners);
+
+	std::uint64_t hash = 14695981039346656037ull;		// FNV-1a
+	for (const std::string &line : lines)
+		for (char ch : line + "\n")
+			hash = (hash ^ static_cast<unsigned char>(ch)) * 1099511628211ull;
+
+	std::vector<long long> lat[LC_COUNT];
+	for (auto &v : lat)
+		v.reserve(args.cmds);
+
+	double secs;
+	if (args.sock)
+	{
+		std::vector<long long> all;
+		if (!run_remote(args, lines, owners, all, secs))
+			return EXIT_FAILURE;
+		for (std::size_t i = 0; i < lines.size(); i++)
+			lat[kinds[i]].push_back(all[i]);
+	}
+	else
+	{
+		Null_buf quiet;
+		std::streambuf *out = std::cout.rdbuf(&quiet);
+
+		Load_rand rnd(args.seed);
+		exec_cmd("set plimit 65535");
+		exec_cmd("set show " + std::to_string(args.show));
+		for (unsigned i = 0; i < args.players; i++)
+			exec_cmd("player add p" + std::to_string(i) + " " +
+						std::to_string(static_cast<int>(rnd.below(201)) - 100));
+
+		using clock = std::chrono::steady_clock;
+		clock::time_point start = clock::now();
+		for (std::size_t i = 0; i < lines.size(); i++)
+		{
+			clock::time_point t0 = clock::now();
+			exec_cmd(lines[i]);
+			clock::time_point t1 = clock::now();
+			lat[kinds[i]].push_back(
+				std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0)
+					.count());
+		}
+		secs = std::chrono::duration<double>(clock::now() - start).count();
+
+		std::cout.rdbuf(out);
+	}
+
+	std::printf("# command\tcount\tp50_ns\tp99_ns\tp999_ns\tmax_ns\n");
+	for (int k = 0; k < LC_COUNT; k++)
+	{
+		std::sort(lat[k].begin(), lat[k].end());
+		std::printf("%s\t%zu\t%lld\t%lld\t%lld\t%lld\n", load_names[k],
+					lat[k].size(), percentile(lat[k], 0.5),
+					percentile(lat[k], 0.99), percentile(lat[k], 0.999),
+					lat[k].empty() ? 0 : lat[k].back());
+	}
+	std::printf("# total\tcommands\tseconds\tcommands_per_s\tstream_hash\n");
+	std::printf("total\t%zu\t%.3f\t%.0f\t%016llx\n", lines.size(), secs,
+				lines.size() / secs, static_cast<unsigned long long>(hash));
+
+	return EXIT_SUCCESS;
+}
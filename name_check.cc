@@ -0,0 +1,117 @@
+/**
+ * @file name_check.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the player name validator
+ */
+
+#include "name_check.h"
+#include <array>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+/**
+ * @brief Builds the table of the name characters
+ * @return Table, 1 for the allowed bytes
+ */
+static constexpr std::array<unsigned char, 256> name_table()
+{
+	std::array<unsigned char, 256> t{};
+	for (int c = '0'; c <= '9'; c++)
+		t[c] = 1;
+	for (int c = 'a'; c <= 'z'; c++)
+		t[c] = t[c - 'a' + 'A'] = 1;
+	for (char c : {'_', '@', '$', '*', '-'})
+		t[static_cast<unsigned char>(c)] = 1;
+	return t;
+}
+
+///< 1 for the bytes allowed in a name
+static constexpr std::array<unsigned char, 256> NAME_CHARS = name_table();
+
+static_assert(NAME_CHARS['x'] && NAME_CHARS['Q'] && NAME_CHARS['-'] &&
+				!NAME_CHARS['#'] && !NAME_CHARS['('] && !NAME_CHARS[' '] &&
+				!NAME_CHARS[0x80], "Name table is broken");
+
+#ifdef __SSE2__
+/**
+ * @brief Classifies 16 bytes, bytes over 0x7f are negative in the signed
+ *	comparisons, so they fall out of all the ranges
+ * @param v Bytes
+ * @return Mask with a bit set for every allowed byte
+ */
+static inline unsigned name_mask(__m128i v)
+{
+	auto in = [](__m128i x, char lo, char hi)
+	{
+		return _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(lo - 1)),
+								_mm_cmplt_epi8(x, _mm_set1_epi8(hi + 1)));
+	};
+
+	__m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));	// A-Z to a-z
+	__m128i ok = _mm_or_si128(in(v, '0', '9'), in(lower, 'a', 'z'));
+	ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+	ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8('@')));
+	ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8('$')));
+	ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8('*')));
+	ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8('-')));
+
+	return _mm_movemask_epi8(ok);
+}
+#endif
+
+/**
+ * @brief Checks that a name has only the allowed characters, its length
+ *	is checked by the callers
+ * @param name Player name, an empty name is valid
+ * @return True if the name matches the grammar
+ */
+bool valid_name(std::string_view name)
+{
+#ifdef __SSE2__
+	const char *p = name.data();
+	std::size_t left = name.size();
+
+	for (; left >= 16; p += 16, left -= 16)
+		if (name_mask(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)))
+				!= 0xffff)
+			return false;
+
+	if (!left)
+		return true;
+
+	// the tail is copied, so nothing is read past the name, the padding
+	// is an allowed char
+	alignas(16) char tail[16];
+	std::memset(tail, 'a', sizeof(tail));
+	std::memcpy(tail, p, left);
+	return name_mask(_mm_load_si128(reinterpret_cast<const __m128i *>(tail)))
+			== 0xffff;
+#else
+	unsigned char ok = 1;
+	for (char c : name)
+		ok &= NAME_CHARS[static_cast<unsigned char>(c)];
+	return ok;
+#endif
+}
+
+/**
+ * @brief Checks many names in one call
+ * @param names Player names
+ * @param n Number of the names
+ * @param ok Output, validity of each name
+ * @return Number of the valid names
+ */
+std::size_t valid_names(const std::string_view *names, std::size_t n,
+						bool *ok)
+{
+	std::size_t valid = 0;
+	for (std::size_t i = 0; i < n; i++)
+		valid += ok[i] = valid_name(names[i]);
+
+	return valid;
+}
@@ -0,0 +1,24 @@
+/**
+ * @file name_check.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Validator of player names, ^([a-z]|[A-Z]|[0-9]|[_@$*-])*$
+ *	Characters are classified 16 at a time with SSE2 range comparisons
+ *	where available, otherwise by a 256 entry lookup table, so a name of
+ *	up to 40 chars takes a few instructions and no regular expression.
+ *	Only the given names are checked, the "(N)" suffixes appended to make
+ *	them unique are not part of the grammar. The empty name matches the
+ *	grammar, the callers reject it with their own message.
+ */
+
+#ifndef NAME_CHECK_H
+#define NAME_CHECK_H
+
+#include <cstddef>
+#include <string_view>
+
+bool valid_name(std::string_view name);
+std::size_t valid_names(const std::string_view *names, std::size_t n,
+						bool *ok);
+
+#endif	// include NAME_CHECK_H
@@ -0,0 +1,284 @@
+/**
+ * @file name_trie.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the trie of player names
+ */
+
+#include "name_trie.h"
+#include <algorithm>
+
+
+/**
+ * @brief Adds a name
+ * @param name Name not in the trie yet
+ * @param slot Slot of the player
+ */
+void Name_trie::insert(std::string_view name, Slot slot)
+{
+	Node_id node = 0;
+	nodes[0].count++;
+	for (char c : name)
+	{
+		node = add_child(node, c);
+		nodes[node].count++;
+	}
+	nodes[node].slot = slot;
+}
+
+/**
+ * @brief Removes a name, nodes left without names are freed
+ * @param name Name in the trie
+ */
+void Name_trie::erase(std::string_view name)
+{
+	Node_id node = 0;
+	nodes[0].count--;
+	for (char c : name)
+	{
+		Node_id next = child(node, c);
+		if (!--nodes[next].count)
+		{
+			// only the erased name went through, so the rest is a chain
+			unlink(node, next);
+			while (next != NO_NODE)
+			{
+				Node_id below = nodes[next].child;
+				nodes[next] = Node();
+				free_n.push_back(next);
+				next = below;
+			}
+			return;
+		}
+		node = next;
+	}
+	nodes[node].slot = NONE;
+}
+
+/**
+ * @brief Removes all the names
+ */
+void Name_trie::clear()
+{
+	nodes.assign(1, Node());
+	free_n.clear();
+}
+
+/**
+ * @brief Finds names by a prefix, or by a pattern with TRIE_ONE and
+ *	TRIE_ANY chars, which has to match the whole name. Chars before the
+ *	first wildcard are walked as a prefix, the rest is matched by a set of
+ *	pattern positions carried down the subtree, branches are left once
+ *	the set is empty.
+ * @param pattern Prefix or pattern, at most TRIE_PATTERN chars
+ * @param max Most slots returned
+ * @param out Output, slots of the first names in the order of bytes
+ * @return Number of all the matching names
+ */
+std::size_t Name_trie::find(std::string_view pattern, std::size_t max,
+							std::vector<Slot> &out) const
+{
+	out.clear();
+	if (pattern.size() > TRIE_PATTERN)
+		return 0;
+
+	const char wild[] = {TRIE_ONE, TRIE_ANY, '\0'};
+	std::size_t head = pattern.find_first_of(wild);
+	Node_id node = 0;
+	for (std::size_t i = 0; i < std::min(head, pattern.size()); i++)
+		if ((node = child(node, pattern[i])) == NO_NODE)
+			return 0;
+
+	if (head == std::string_view::npos)
+	{
+		collect(node, max, out);
+		return nodes[node].count;
+	}
+
+	std::size_t total = 0;
+	pattern.remove_prefix(head);
+	match(node, pattern, closure(pattern, 1), max, out, total);
+	return total;
+}
+
+/**
+ * @brief Completes a prefix, as far as all the names with it agree
+ * @param prefix Start of the names
+ * @param common Output, the prefix with the chars common to the names
+ * @param max Most slots returned
+ * @param out Output, slots of the first names with the prefix
+ * @return Number of all the names with the prefix
+ */
+std::size_t Name_trie::complete(std::string_view prefix, std::string &common,
+								std::size_t max,
+								std::vector<Slot> &out) const
+{
+	out.clear();
+	common = prefix;
+
+	Node_id node = 0;
+	for (char c : prefix)
+		if ((node = child(node, c)) == NO_NODE)
+			return 0;
+
+	// a single child without a name ending before it belongs to all
+	for (Node_id next = nodes[node].child; nodes[node].slot == NONE &&
+			next != NO_NODE && nodes[next].next == NO_NODE;
+			next = nodes[node].child)
+	{
+		common += nodes[next].c;
+		node = next;
+	}
+
+	collect(node, max, out);
+	return nodes[node].count;
+}
+
+/**
+ * @brief Finds a child of a node
+ * @param parent Parent node
+ * @param c Char of the child
+ * @return Child node, NO_NODE if there is none
+ */
+Name_trie::Node_id Name_trie::child(Node_id parent, char c) const
+{
+	unsigned char uc = c;
+	Node_id node = nodes[parent].child;
+	while (node != NO_NODE && static_cast<unsigned char>(nodes[node].c) < uc)
+		node = nodes[node].next;
+
+	return node != NO_NODE && nodes[node].c == c ? node : NO_NODE;
+}
+
+/**
+ * @brief Finds a child of a node, or adds it at its place among siblings
+ * @param parent Parent node
+ * @param c Char of the child
+ * @return Child node
+ */
+Name_trie::Node_id Name_trie::add_child(Node_id parent, char c)
+{
+	unsigned char uc = c;
+	Node_id prev = NO_NODE, node = nodes[parent].child;
+	while (node != NO_NODE && static_cast<unsigned char>(nodes[node].c) < uc)
+	{
+		prev = node;
+		node = nodes[node].next;
+	}
+	if (node != NO_NODE && nodes[node].c == c)
+		return node;
+
+	Node_id added;
+	if (!free_n.empty())
+	{
+		added = free_n.back();
+		free_n.pop_back();
+	}
+	else
+	{
+		added = nodes.size();
+		nodes.emplace_back();
+	}
+
+	nodes[added].c = c;
+	nodes[added].next = node;
+	(prev == NO_NODE ? nodes[parent].child : nodes[prev].next) = added;
+	return added;
+}
+
+/**
+ * @brief Removes a child from the siblings
+ * @param parent Parent node
+ * @param node Child node
+ */
+void Name_trie::unlink(Node_id parent, Node_id node)
+{
+	Node_id *link = &nodes[parent].child;
+	while (*link != node)
+		link = &nodes[*link].next;
+	*link = nodes[node].next;
+}
+
+/**
+ * @brief Collects names of a subtree in the order of bytes, a name comes
+ *	before the longer names it starts
+ * @param node Root of the subtree
+ * @param max Most slots in the output
+ * @param out Output, slots are appended
+ */
+void Name_trie::collect(Node_id node, std::size_t max,
+						std::vector<Slot> &out) const
+{
+	if (out.size() >= max)
+		return;
+	if (nodes[node].slot != NONE)
+		out.push_back(nodes[node].slot);
+
+	for (Node_id c = nodes[node].child; c != NO_NODE && out.size() < max;
+			c = nodes[c].next)
+		collect(c, max, out);
+}
+
+/**
+ * @brief Matches the rest of a pattern in a subtree
+ * @param node Node reached
+ * @param pattern Pattern from its first wildcard
+ * @param states Bit i set if the first i chars of the pattern match
+ * @param max Most slots in the output
+ * @param out Output, slots are appended
+ * @param total Number of the matching names, increased
+ */
+void Name_trie::match(Node_id node, std::string_view pattern,
+						std::uint64_t states, std::size_t max,
+						std::vector<Slot> &out, std::size_t &total) const
+{
+	std::size_t len = pattern.size();
+	std::uint64_t end = std::uint64_t(1) << len;
+
+	// pattern ending with TRIE_ANY matched, so does every longer name
+	if ((states & end) && pattern[len - 1] == TRIE_ANY)
+	{
+		total += nodes[node].count;
+		collect(node, max, out);
+		return;
+	}
+	if ((states & end) && nodes[node].slot != NONE)
+	{
+		total++;
+		if (out.size() < max)
+			out.push_back(nodes[node].slot);
+	}
+
+	for (Node_id c = nodes[node].child; c != NO_NODE; c = nodes[c].next)
+	{
+		std::uint64_t next = 0;
+		for (std::size_t i = 0; i < len; i++)
+		{
+			if (!(states >> i & 1))
+				continue;
+			if (pattern[i] == TRIE_ANY)
+				next |= std::uint64_t(1) << i;
+			else if (pattern[i] == TRIE_ONE || pattern[i] == nodes[c].c)
+				next |= std::uint64_t(1) << (i + 1);
+		}
+
+		if (next)
+			match(c, pattern, closure(pattern, next), max, out, total);
+	}
+}
+
+/**
+ * @brief Adds the positions after TRIE_ANY chars, which match no chars
+ * @param pattern Pattern
+ * @param states Bit i set if the first i chars of the pattern match
+ * @return States with the skipped TRIE_ANY chars
+ */
+std::uint64_t Name_trie::closure(std::string_view pattern,
+									std::uint64_t states)
+{
+	for (std::size_t i = 0; i < pattern.size(); i++)
+		if ((states >> i & 1) && pattern[i] == TRIE_ANY)
+			states |= std::uint64_t(1) << (i + 1);
+
+	return states;
+}
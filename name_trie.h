@@ -0,0 +1,79 @@
+/**
+ * @file name_trie.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Trie of the player names, for search by prefix or pattern and
+ *	for completion of names
+ *	Nodes are kept in one array and linked by indexes, children of a node
+ *	are a list of siblings sorted by their char, so names are visited in
+ *	the order of bytes. Every node counts the names below it, so the
+ *	number of names with a prefix is known after walking the prefix, and
+ *	collecting the first names does not visit the rest.
+ */
+
+#ifndef NAME_TRIE_H
+#define NAME_TRIE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+const char TRIE_ONE = '?';		///< Pattern char matching any one char
+const char TRIE_ANY = '%';		///< Pattern char matching any chars
+const std::size_t TRIE_PATTERN = 63;	///< Longest pattern
+
+/**
+ * @brief Trie of names, each name leads to the slot of its player in the
+ *	player store, which owns the trie
+ */
+class Name_trie
+{
+	public:
+		typedef std::uint32_t Slot;
+		static const Slot NONE = ~static_cast<Slot>(0);	///< Same as NO_SLOT
+	private:
+		typedef std::uint32_t Node_id;
+		static const Node_id NO_NODE = ~static_cast<Node_id>(0);
+
+		/**
+		 * @brief Char of a name, the root has none
+		 */
+		struct Node
+		{
+			Node_id child = NO_NODE;	///< First child, the lowest char
+			Node_id next = NO_NODE;		///< Next sibling, a higher char
+			Slot slot = NONE;			///< Player whose name ends here
+			std::uint32_t count = 0;	///< Names ending in the subtree
+			char c = 0;					///< Char of the node
+		};
+
+		std::vector<Node> nodes;		///< Nodes, root at 0
+		std::vector<Node_id> free_n;	///< Nodes free for reuse
+	public:
+		Name_trie(): nodes(1) {}
+
+		void insert(std::string_view name, Slot slot);
+		void erase(std::string_view name);
+		void clear();
+
+		std::size_t find(std::string_view pattern, std::size_t max,
+							std::vector<Slot> &out) const;
+		std::size_t complete(std::string_view prefix, std::string &common,
+								std::size_t max,
+								std::vector<Slot> &out) const;
+		std::size_t size() const { return nodes[0].count; }
+	private:
+		Node_id child(Node_id parent, char c) const;
+		Node_id add_child(Node_id parent, char c);
+		void unlink(Node_id parent, Node_id node);
+		void collect(Node_id node, std::size_t max,
+						std::vector<Slot> &out) const;
+		void match(Node_id node, std::string_view pattern, std::uint64_t states,
+					std::size_t max, std::vector<Slot> &out,
+					std::size_t &total) const;
+		static std::uint64_t closure(std::string_view pattern,
+										std::uint64_t states);
+};
+
+#endif	// include NAME_TRIE_H
@@ -0,0 +1,240 @@
+/**
+ * @file player_store.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the structure-of-arrays player store
+ */
+
+#include "player_store.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+
+/**
+ * @brief Adds a player
+ * @param name Unique player name, not empty, at most SLOT_NAME chars are
+ *	kept
+ * @param score Player score
+ * @param id Id of the player restored from a snapshot, a new id is given
+ *	if it is 0, already used or not given yet, i.e. not below the next id
+ * @return Slot of the player
+ */
+Pl_slot Player_store::add(std::string_view name, int score, Pl_id id)
+{
+	assert(!name.empty() && "length 0 marks a free slot");
+	name = name.substr(0, SLOT_NAME);
+
+	// name index is kept at most half full, so probe sequences stay short
+	if (2 * (count + 1) > table.size())
+		rehash(std::max<std::size_t>(16, 2 * table.size()));
+
+	Pl_slot slot;
+	if (!free_s.empty())
+	{
+		slot = free_s.back();
+		free_s.pop_back();
+	}
+	else
+	{
+		slot = names.size();
+		names.emplace_back();
+		lens.push_back(0);
+		scores.push_back(0);
+		ids.push_back(0);
+	}
+
+	// a restored id was given before, a bad one does not grow the slots
+	if (!id.num || id.num >= next || find(id) != NO_SLOT)
+		id.num = next++;
+	record(SK_JOIN, id.num, score);
+	if (id.num >= id_slots.size())
+		id_slots.resize(std::max<std::size_t>(id.num + 1, 2 * id_slots.size()),
+						NO_SLOT);
+	id_slots[id.num] = slot;
+
+	std::memcpy(names[slot].str, name.data(), name.size());
+	lens[slot] = name.size();
+	scores[slot] = score;
+	ids[slot] = id.num;
+	index_add(slot);
+	trie.insert(this->name(slot), slot);
+	count++;
+
+	return slot;
+}
+
+/**
+ * @brief Removes a player, his slot is freed, his id is not given again
+ * @param slot Slot of the player
+ */
+void Player_store::remove(Pl_slot slot)
+{
+	series.leave(ids[slot], name(slot));
+	record(SK_LEAVE, ids[slot], -scores[slot]);
+	index_remove(slot);
+	trie.erase(name(slot));
+	id_slots[ids[slot]] = NO_SLOT;
+	lens[slot] = 0;
+	(hold ? held_s : free_s).push_back(slot);
+	count--;
+}
+
+/**
+ * @brief Changes name of a player, the slot stays the same
+ * @param slot Slot of the player
+ * @param name New unique name, not empty
+ */
+void Player_store::rename(Pl_slot slot, std::string_view name)
+{
+	assert(!name.empty() && "length 0 marks a free slot");
+	name = name.substr(0, SLOT_NAME);
+
+	index_remove(slot);
+	trie.erase(this->name(slot));
+	std::memmove(names[slot].str, name.data(), name.size());
+	lens[slot] = name.size();
+	index_add(slot);
+	trie.insert(this->name(slot), slot);
+}
+
+/**
+ * @brief Removes all the players, next ids continue after the last one
+ */
+void Player_store::clear()
+{
+	if (count)
+	{
+		for (Pl_slot s = 0; s < slots(); s++)
+			if (used(s))
+				series.leave(ids[s], name(s));
+		record(SK_CLEAR, 0, 0);
+	}
+
+	table.clear();
+	names.clear();
+	lens.clear();
+	scores.clear();
+	ids.clear();
+	id_slots.clear();
+	free_s.clear();
+	held_s.clear();
+	trie.clear();
+	count = 0;
+}
+
+/**
+ * @brief Makes room for players, so adding them up to the number does
+ *	not grow the arrays or the name index
+ * @param players Number of all the players
+ */
+void Player_store::reserve(std::size_t players)
+{
+	names.reserve(players);
+	lens.reserve(players);
+	scores.reserve(players);
+	ids.reserve(players);
+
+	std::size_t size = std::max<std::size_t>(16, table.size());
+	while (2 * (players + 1) > size)
+		size *= 2;
+	if (size != table.size())
+		rehash(size);
+}
+
+/**
+ * @brief Holds reuse of freed slots, so a slot removed in a batch does
+ *	not get to another player until the batch ends
+ * @param on Hold, or release the held slots
+ */
+void Player_store::hold_slots(bool on)
+{
+	hold = on;
+	if (!hold)
+	{
+		free_s.insert(free_s.end(), held_s.begin(), held_s.end());
+		held_s.clear();
+	}
+}
+
+/**
+ * @brief Adds a slot to the name index, the table has a free entry
+ * @param slot Slot with the name already stored
+ */
+void Player_store::index_add(Pl_slot slot)
+{
+	std::size_t i = home(name(slot));
+	while (table[i] != NO_SLOT)
+		i = (i + 1) & (table.size() - 1);
+	table[i] = slot;
+}
+
+/**
+ * @brief Removes a slot from the name index, the following entries of the
+ *	probe sequence are shifted back, so no tombstones are needed
+ * @param slot Slot with its name still stored
+ */
+void Player_store::index_remove(Pl_slot slot)
+{
+	std::size_t mask = table.size() - 1;
+	std::size_t i = home(name(slot));
+	while (table[i] != slot)
+		i = (i + 1) & mask;
+
+	for (std::size_t j = (i + 1) & mask; table[j] != NO_SLOT; 
+			j = (j + 1) & mask)
+	{
+		// entry at j can fill the hole at i if its home is not in (i, j]
+		std::size_t k = home(name(table[j]));
+		if ((j > i && (k <= i || k > j)) || (j < i && k <= i && k > j))
+		{
+			table[i] = table[j];
+			i = j;
+		}
+	}
+
+	table[i] = NO_SLOT;
+}
+
+/**
+ * @brief Builds the name index again with a different size
+ * @param size New size of the table, a power of two
+ */
+void Player_store::rehash(std::size_t size)
+{
+	table.assign(size, NO_SLOT);
+	for (Pl_slot s = 0; s < slots(); s++)
+	{
+		if (!used(s))
+			continue;
+
+		std::size_t i = home(name(s));
+		while (table[i] != NO_SLOT)
+			i = (i + 1) & (size - 1);
+		table[i] = s;
+	}
+}
+
+/**
+ * @brief Records an event in the time series, a checkpoint of the scores
+ *	before the event is taken first if the segment is full
+ * @param kind What happened
+ * @param id Id of the player
+ * @param delta Change of the score
+ */
+void Player_store::record(Series_kind kind, std::uint32_t id, int delta)
+{
+	if (series.need_checkpoint())
+	{
+		std::vector<std::pair<std::uint32_t, int>> state;
+		state.reserve(count);
+		for (Pl_slot s = 0; s < slots(); s++)
+			if (used(s))
+				state.emplace_back(ids[s], scores[s]);
+
+		std::sort(state.begin(), state.end());
+		series.checkpoint(state);
+	}
+
+	series.record(kind, id, delta);
+}
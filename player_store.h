@@ -0,0 +1,141 @@
+/**
+ * @file player_store.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Structure-of-arrays store of the scoreboard players
+ *	Every player occupies a slot, the same index in the array of names,
+ *	of name lengths and of scores. Names are stored inline in fixed slots
+ *	of SLOT_NAME chars, so a player costs no allocation of its own, and
+ *	scans over the scores are linear in the memory. Names are found by an
+ *	open addressing hash table of slots (linear probing).
+ *	Every player gets a numeric id on creation, ids are never given to
+ *	another player, so they can be kept by the clients, an id is found
+ *	by a single access to the array of slots indexed by ids.
+ *	Names are also kept in a trie, for the search by prefix or pattern.
+ *	Every change of a score, every added and removed player is recorded
+ *	in the time series of scores, with the id of the player.
+ */
+
+#ifndef PLAYER_STORE_H
+#define PLAYER_STORE_H
+
+#include "name_trie.h"
+#include "score_series.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+// Index of a player in the store, stable while the player exists
+typedef std::uint32_t Pl_slot;
+
+const Pl_slot NO_SLOT = ~static_cast<Pl_slot>(0);	///< No such player
+const unsigned SLOT_NAME = 40;	///< Size of a name slot, PNAME_LIMIT
+///< Ids read from files are below, the array of slots by ids stays small
+const std::uint32_t ID_LIMIT = 1u << 24;
+
+/**
+ * @brief Id of a player, unique for the whole life of the scoreboard,
+ *	a distinct type, so it is not mistaken for a rank
+ */
+struct Pl_id
+{
+	std::uint32_t num;			///< 0 is no id
+};
+
+/**
+ * @brief Player store, slots of removed players are reused
+ */
+class Player_store
+{
+		/**
+		 * @brief Name of a player, not terminated if SLOT_NAME long
+		 */
+		struct Name_slot
+		{
+			char str[SLOT_NAME];
+		};
+
+		std::vector<Name_slot> names;		///< Names of the slots
+		std::vector<unsigned char> lens;	///< Name lengths, 0 free slot
+		std::vector<int> scores;			///< Scores of the slots
+		std::vector<std::uint32_t> ids;		///< Ids of the slots
+		std::vector<Pl_slot> free_s;		///< Free slots
+		std::vector<Pl_slot> held_s;		///< Freed while reuse is held
+		bool hold;							///< Freed slots are not reused
+		unsigned count;						///< Number of players
+		std::vector<Pl_slot> table;			///< Name index, NO_SLOT empty
+		std::vector<Pl_slot> id_slots;		///< Slots by ids, NO_SLOT gone
+		std::uint32_t next;					///< Id of the next new player
+		Name_trie trie;						///< Names in the order of bytes
+		Score_series series;				///< Past changes of the scores
+	public:
+		Player_store(): hold{false}, count{0}, next{1} {}
+		Player_store(const Player_store &) = delete;
+		Player_store &operator=(const Player_store &) = delete;
+
+		Pl_slot add(std::string_view name, int score, Pl_id id = {0});
+		void remove(Pl_slot slot);
+		void rename(Pl_slot slot, std::string_view name);
+		void clear();
+		void reserve(std::size_t players);
+		void hold_slots(bool on);
+
+		Pl_slot find(std::string_view name) const;
+		Pl_slot find(Pl_id id) const
+		{
+			return id.num < id_slots.size() ? id_slots[id.num] : NO_SLOT;
+		}
+
+		std::string_view name(Pl_slot slot) const
+		{
+			return std::string_view(names[slot].str, lens[slot]);
+		}
+		int score(Pl_slot slot) const { return scores[slot]; }
+		void set_score(Pl_slot slot, int score)
+		{
+			if (score != scores[slot] && lens[slot])	// free slots are reset
+				record(SK_SCORE, ids[slot], score - scores[slot]);
+			scores[slot] = score;
+		}
+		Pl_id id(Pl_slot slot) const { return Pl_id{ids[slot]}; }
+		Pl_id next_id() const { return Pl_id{next}; }
+		void set_next_id(Pl_id id) { next = std::max(next, id.num); }
+
+		bool used(Pl_slot slot) const { return lens[slot]; }
+		Pl_slot slots() const { return lens.size(); }	///< Slots in use
+		unsigned size() const { return count; }			///< Players
+		bool empty() const { return !count; }
+		const Name_trie &prefixes() const { return trie; }
+		const Score_series &timeline() const { return series; }
+	private:
+		std::size_t home(std::string_view name) const
+		{
+			return std::hash<std::string_view>()(name) & (table.size() - 1);
+		}
+		void index_add(Pl_slot slot);
+		void index_remove(Pl_slot slot);
+		void rehash(std::size_t size);
+		void record(Series_kind kind, std::uint32_t id, int delta);
+};
+
+/**
+ * @brief Finds a player by name
+ * @param name Player name
+ * @return Slot of the player, NO_SLOT if there is no such player
+ */
+inline Pl_slot Player_store::find(std::string_view name) const
+{
+	if (table.empty())
+		return NO_SLOT;
+
+	for (std::size_t i = home(name); table[i] != NO_SLOT; 
+			i = (i + 1) & (table.size() - 1))
+		if (this->name(table[i]) == name)
+			return table[i];
+
+	return NO_SLOT;
+}
+
+#endif	// include PLAYER_STORE_H
@@ -0,0 +1,261 @@
+/**
+ * @file rank_index.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the order-statistic ranking index
+ */
+
+#include "rank_index.h"
+
+
+/**
+ * @brief Xorshift generator of node priorities
+ */
+unsigned Rank_index::next_prio()
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+/**
+ * @brief Takes a node from the pool, or enlarges the pool
+ * @param slot Player stored in the node
+ * @return Index of the new node
+ */
+int Rank_index::new_node(Pl_slot slot)
+{
+	Node node{slot, store.score(slot), next_prio(), 0, 0, 1};
+
+	if (free_n.empty())
+	{
+		nodes.push_back(node);
+		return nodes.size()-1;
+	}
+
+	int n = free_n.back();
+	free_n.pop_back();
+	nodes[n] = node;
+	return n;
+}
+
+/**
+ * @brief Splits a subtree to players ranked above the key and the rest
+ * @param n Root of the subtree
+ * @param score, name Key of the split
+ * @param l Output, players ranked above the key
+ * @param r Output, the key and players ranked below
+ */
+void Rank_index::split(int n, int score, std::string_view name, int &l,
+						int &r)
+{
+	if (!n)
+	{
+		l = r = 0;
+		return;
+	}
+
+	if (higher(nodes[n].score, store.name(nodes[n].slot), score, name))
+	{
+		split(nodes[n].right, score, name, nodes[n].right, r);
+		l = n;
+	}
+	else
+	{
+		split(nodes[n].left, score, name, l, nodes[n].left);
+		r = n;
+	}
+
+	update(n);
+}
+
+/**
+ * @brief Merges two subtrees, all players of l are ranked above r
+ * @return Root of the merged subtree
+ */
+int Rank_index::merge(int l, int r)
+{
+	if (!l || !r)
+		return l ? l : r;
+
+	if (nodes[l].prio > nodes[r].prio)
+	{
+		nodes[l].right = merge(nodes[l].right, r);
+		update(l);
+		return l;
+	}
+
+	nodes[r].left = merge(l, nodes[r].left);
+	update(r);
+	return r;
+}
+
+/**
+ * @brief Removes a player from a subtree, his node is replaced by the
+ *	merge of its children
+ * @param n Root of the subtree, changed to the new root
+ * @param slot, score, name Player and the key he was inserted with
+ * @return Rank of the player in the subtree, 0 if not in it
+ */
+int Rank_index::remove(int &n, Pl_slot slot, int score, std::string_view name)
+{
+	if (!n)
+		return 0;
+
+	int above = nodes[nodes[n].left].cnt;
+	if (nodes[n].slot == slot)
+	{
+		free_n.push_back(n);
+		n = merge(nodes[n].left, nodes[n].right);
+		return above + 1;
+	}
+
+	int rank;
+	if (higher(score, name, nodes[n].score, store.name(nodes[n].slot)))
+		rank = remove(nodes[n].left, slot, score, name);
+	else if ((rank = remove(nodes[n].right, slot, score, name)))
+		rank += above + 1;
+
+	if (rank)
+		update(n);
+	return rank;
+}
+
+/**
+ * @brief Inserts a player to the index, using his current score
+ * @param slot Slot of the player
+ * @return Rank of the player
+ */
+int Rank_index::insert(Pl_slot slot)
+{
+	int l, r;
+	split(root, store.score(slot), store.name(slot), l, r);
+	int rank = nodes[l].cnt + 1;
+	root = merge(merge(l, new_node(slot)), r);
+	return rank;
+}
+
+/**
+ * @brief Removes a player from the index, his score and name have to be
+ *	the same as when he was inserted
+ * @param slot Slot of the player
+ * @return Rank the player had, 0 if not indexed
+ */
+int Rank_index::erase(Pl_slot slot)
+{
+	return remove(root, slot, store.score(slot), store.name(slot));
+}
+
+/**
+ * @brief Rebuilds the index in linear time from players already sorted
+ *	by their ranking
+ * @param sorted Players in the order of ranking
+ */
+void Rank_index::build(const std::vector<Pl_slot> &sorted)
+{
+	clear();
+	nodes.reserve(sorted.size()+1);
+
+	// cartesian tree over the priorities, right spine kept on a stack
+	std::vector<int> spine;
+	for (Pl_slot slot : sorted)
+	{
+		int n = new_node(slot);
+		int last = 0;
+		while (!spine.empty() && nodes[spine.back()].prio < nodes[n].prio)
+		{
+			last = spine.back();
+			spine.pop_back();
+		}
+
+		nodes[n].left = last;
+		if (!spine.empty())
+			nodes[spine.back()].right = n;
+		spine.push_back(n);
+	}
+
+	if (spine.empty())
+		return;
+	root = spine.front();
+
+	// subtree sizes, children are always pushed after their parents
+	std::vector<int> order{root};
+	for (unsigned i = 0; i < order.size(); i++)
+	{
+		if (nodes[order[i]].left)
+			order.push_back(nodes[order[i]].left);
+		if (nodes[order[i]].right)
+			order.push_back(nodes[order[i]].right);
+	}
+
+	for (auto it = order.rbegin(); it != order.rend(); it++)
+		update(*it);
+}
+
+/**
+ * @brief Removes all players from the index
+ */
+void Rank_index::clear()
+{
+	nodes.resize(1);
+	free_n.clear();
+	root = 0;
+}
+
+/**
+ * @brief Finds a player by his rank
+ * @param rank Position in the scoreboard, from 1
+ * @return Slot of the player, NO_SLOT if no such rank
+ */
+Pl_slot Rank_index::select(int rank) const
+{
+	if (rank < 1 || static_cast<unsigned>(rank) > size())
+		return NO_SLOT;
+
+	int n = root;
+	while (n)
+	{
+		int above = nodes[nodes[n].left].cnt;
+		if (rank <= above)
+			n = nodes[n].left;
+		else if (rank == above + 1)
+			return nodes[n].slot;
+		else
+		{
+			rank -= above + 1;
+			n = nodes[n].right;
+		}
+	}
+
+	return NO_SLOT;
+}
+
+/**
+ * @brief Computes rank of an indexed player
+ * @param slot Slot of the player
+ * @return Rank of the player, 0 if not indexed
+ */
+int Rank_index::rank(Pl_slot slot) const
+{
+	int n = root;
+	int rank = 0;
+	int score = store.score(slot);
+	std::string_view name = store.name(slot);
+
+	while (n)
+	{
+		if (nodes[n].slot == slot)
+			return rank + nodes[nodes[n].left].cnt + 1;
+
+		if (higher(score, name, nodes[n].score, store.name(nodes[n].slot)))
+			n = nodes[n].left;
+		else
+		{
+			rank += nodes[nodes[n].left].cnt + 1;
+			n = nodes[n].right;
+		}
+	}
+
+	return 0;
+}
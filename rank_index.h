@@ -0,0 +1,119 @@
+/**
+ * @file rank_index.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Order-statistic ranking index of the scoreboard players
+ *	Players are kept ordered by score descending and by name ascending
+ *	when scores match, in a treap augmented with subtree sizes.
+ *	Nodes refer to the players by their slots in the player store.
+ */
+
+#ifndef RANK_INDEX_H
+#define RANK_INDEX_H
+
+#include "player_store.h"
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Ranking index, every update and rank query is O(log n)
+ *	The index does not own the players, it only refers to the slots of
+ *	the player store, and keeps a copy of the score it was inserted with,
+ *	so a player has to be erased before his score or name is modified.
+ */
+class Rank_index
+{
+		/**
+		 * @brief Tree node, node 0 is a sentinel used as an empty child
+		 */
+		struct Node
+		{
+			Pl_slot slot;		///< Indexed player
+			int score;			///< Score the player was indexed with
+			unsigned prio;		///< Heap priority of the treap
+			int left;			///< Left subtree (higher ranks)
+			int right;			///< Right subtree (lower ranks)
+			int cnt;			///< Number of nodes in the subtree
+		};
+
+		std::vector<Node> nodes;	///< Node pool, [0] is the sentinel
+		std::vector<int> free_n;	///< Unused nodes of the pool
+		mutable std::vector<int> walk;	///< Stack of for_each, kept for reuse
+		int root;					///< Root of the tree
+		unsigned seed;				///< State of the priority generator
+		const Player_store &store;	///< Names of the players
+	public:
+		explicit Rank_index(const Player_store &players): 
+			nodes(1, Node{NO_SLOT, 0, 0, 0, 0, 0}), root{0},
+			seed{2463534242u}, store(players) {}
+
+		int insert(Pl_slot slot);
+		int erase(Pl_slot slot);
+		void build(const std::vector<Pl_slot> &sorted);
+		void clear();
+
+		Pl_slot select(int rank) const;
+		int rank(Pl_slot slot) const;
+		unsigned size() const { return nodes[root].cnt; }
+
+		template<typename F>
+		void for_each(F func, unsigned limit = ~0u) const;
+
+		static bool higher(int sc_a, std::string_view a, int sc_b,
+							std::string_view b);
+	private:
+		int new_node(Pl_slot slot);
+		void update(int n)
+		{
+			nodes[n].cnt = nodes[nodes[n].left].cnt +
+							nodes[nodes[n].right].cnt + 1;
+		}
+		void split(int n, int score, std::string_view name, int &l, int &r);
+		int merge(int l, int r);
+		int remove(int &n, Pl_slot slot, int score, std::string_view name);
+		unsigned next_prio();
+};
+
+/**
+ * @brief Ranking rule, higher score first, alphabetically when scores match
+ * @return True if player a is ranked above player b
+ */
+inline bool Rank_index::higher(int sc_a, std::string_view a, int sc_b,
+								std::string_view b)
+{
+	return sc_a != sc_b ? sc_a > sc_b : a < b;
+}
+
+/**
+ * @brief Walks the players in the order of their ranking, the stack of the
+ *	last walk is reused, a walk nested in func gets a stack of its own
+ * @param func Called with the rank and the slot of the player
+ * @param limit Maximum number of players visited
+ */
+template<typename F>
+void Rank_index::for_each(F func, unsigned limit) const
+{
+	std::vector<int> stack;
+	stack.swap(walk);
+	stack.clear();
+	int n = root;
+	int rank = 1;
+
+	while ((n || !stack.empty()) && static_cast<unsigned>(rank) <= limit)
+	{
+		while (n)				// descend to the highest rank first
+		{
+			stack.push_back(n);
+			n = nodes[n].left;
+		}
+
+		n = stack.back();
+		stack.pop_back();
+		func(rank++, nodes[n].slot);
+		n = nodes[n].right;
+	}
+
+	walk.swap(stack);
+}
+
+#endif	// include RANK_INDEX_H
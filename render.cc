@@ -0,0 +1,147 @@
+/**
+ * @file render.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the score table renderer
+ */
+
+#include "render.h"
+#include <algorithm>
+#include <charconv>
+#include <csignal>
+#include <cstring>
+#include <sys/ioctl.h>	// get terminal
+#include <unistd.h>
+
+///< Terminal was resized, its width has to be queried again
+static volatile std::sig_atomic_t winch = 1;
+///< Width of the terminal is used, not if the output goes elsewhere
+static bool term_used = true;
+
+/**
+ * @brief SIGWINCH handler
+ */
+static void on_winch(int)
+{
+	winch = 1;
+}
+
+
+/**
+ * @brief Sets width of the table, rebuilds the lines of the layout
+ * @param cols Width of the table in characters
+ */
+void Table_render::set_width(unsigned cols)
+{
+	if (cols < TBL_FRAME + TBL_MIN_NAME + TBL_RANK + TBL_SCORE)
+		cols = TBL_FRAME + TBL_MIN_NAME + TBL_RANK + TBL_SCORE;
+
+	if (cols == width)
+		return;
+
+	width = cols;
+	name_w = width - TBL_FRAME - TBL_RANK - TBL_SCORE;
+
+	top = " " + std::string(width-2, '_') + "\n";
+	sep = " " + std::string(width-2, '-') + "\n";
+
+	head = "| RANK   | PLAYER NAME";
+	head.append(name_w - 11, ' ');
+	head += " | SCORE  |\n";
+
+	// "| " rank " | " name " | " score " |"
+	row_tpl = "| " + std::string(TBL_RANK, ' ') + " | " + 
+		std::string(name_w, ' ') + " | " + std::string(TBL_SCORE, ' ') +
+		" |\n" + sep;
+	score_at = 2 + TBL_RANK + 3 + name_w + 3;
+}
+
+/**
+ * @brief Starts a new table, the header is rendered
+ */
+void Table_render::begin()
+{
+	buf.clear();
+	buf += top;
+	buf += head;
+	buf += sep;
+}
+
+/**
+ * @brief Renders a row of the table, the empty row is copied and the
+ *	player is written to it
+ * @param rank Rank of the player
+ * @param name Player name
+ * @param score Player score
+ */
+void Table_render::row(int rank, std::string_view name, int score)
+{
+	char num[16];
+	char *end;
+	std::size_t at = buf.size();
+
+	buf += row_tpl;
+	char *row = &buf[at];
+
+	end = std::to_chars(num, num + sizeof(num), rank).ptr;
+	*end++ = '.';
+	std::memcpy(row + 2, num, std::min<std::size_t>(end - num, TBL_RANK));
+
+	std::memcpy(row + 2 + TBL_RANK + 3, name.data(),
+				std::min<std::size_t>(name.size(), name_w));
+
+	end = std::to_chars(num, num + sizeof(num), score).ptr;
+	if (end - num <= TBL_SCORE)
+		std::memcpy(row + score_at, num, end - num);
+	else		// does not fit, column is widened in this row
+		buf.replace(at + score_at, TBL_SCORE, num, end - num);
+}
+
+/**
+ * @brief Width of the terminal, queried only on the first call and after
+ *	the terminal is resized, if the output is not a terminal, default
+ *	width is used
+ * @return Number of columns
+ */
+unsigned Table_render::term_width()
+{
+	static unsigned cols = TBL_DEF_WIDTH;
+	static bool watching = false;
+
+	if (!term_used)
+		return TBL_DEF_WIDTH;
+
+	if (!watching)
+	{
+		struct sigaction sa;
+		std::memset(&sa, 0, sizeof(sa));
+		sa.sa_handler = on_winch;
+		sa.sa_flags = SA_RESTART;	// reading commands is not interrupted
+		sigemptyset(&sa.sa_mask);
+		sigaction(SIGWINCH, &sa, nullptr);
+		watching = true;
+	}
+
+	if (winch)
+	{
+		winch = 0;
+		struct winsize w;
+		if (isatty(STDOUT_FILENO) && !ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) &&
+			w.ws_col)
+			cols = w.ws_col;
+		else
+			cols = TBL_DEF_WIDTH;
+	}
+
+	return cols;
+}
+
+/**
+ * @brief Sets whether term_width follows the terminal, the server does
+ *	not render for its terminal
+ * @param on Use the terminal width
+ */
+void Table_render::use_terminal(bool on)
+{
+	term_used = on;
+}
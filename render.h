@@ -0,0 +1,66 @@
+/**
+ * @file render.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Renderer of the score table into a single reusable buffer
+ *	Layout, W being the width of the table:
+ *	 ____________________________________________ (W-2 underscores)
+ *	| RANK   | PLAYER NAME               | SCORE  |
+ *	 -------------------------------------------- (W-2 dashes)
+ *	| 1.     | Dudefish                  | 22     |
+ *	 --------------------------------------------
+ *	Width of the terminal is queried only when it changes (SIGWINCH).
+ */
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Constants of the table layout
+ */
+enum Table_consts
+{
+	TBL_RANK = 6,		///< Width of the rank column, "65535."
+	TBL_SCORE = 6,		///< Width of the score column
+	TBL_FRAME = 10,		///< Borders and padding of the columns
+	TBL_MIN_NAME = 40,	///< Minimal width of the name column, PNAME_LIMIT
+	TBL_DEF_WIDTH = 80	///< Width used if the terminal width is unknown
+};
+
+/**
+ * @brief Formats the whole table into one buffer, which keeps its
+ *	capacity between the prints, lines not depending on the players and
+ *	an empty row, which is filled with the player, are built only when
+ *	the width changes
+ */
+class Table_render
+{
+		std::string buf;		///< Rendered table
+		unsigned width;			///< Width of the table
+		unsigned name_w;		///< Width of the name column
+		std::string top;		///< Top border line
+		std::string head;		///< Header line
+		std::string sep;		///< Separator line
+		std::string row_tpl;	///< Empty row followed by separator
+		std::size_t score_at;	///< Position of the score in the row
+	public:
+		Table_render(): width{0}, name_w{0}, score_at{0} 
+		{
+			set_width(TBL_DEF_WIDTH);
+		}
+
+		void set_width(unsigned cols);
+		void begin();
+		void row(int rank, std::string_view name, int score);
+
+		const char *data() const { return buf.data(); }
+		std::size_t size() const { return buf.size(); }
+
+		static unsigned term_width();
+		static void use_terminal(bool on);
+};
+
+#endif	// include RENDER_H
@@ -0,0 +1,189 @@
+/**
+ * @file roster.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the parallel roster parser
+ */
+
+#include "roster.h"
+#include "scoreboard.h"
+#include "name_check.h"
+#include <cctype>
+#include <charconv>
+#include <memory>
+#include <thread>
+
+
+/**
+ * @brief Parses the text, chunks of at least ROSTER_CHUNK chars are
+ *	parsed by the threads, the first one by the calling thread
+ * @param text Text of the roster
+ * @param max_threads Most threads used, 0 for the number of processors
+ */
+void Roster::parse(std::string_view text, unsigned max_threads)
+{
+	debug_info();
+
+	if (!max_threads)
+		max_threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = std::max<std::size_t>(1, std::min<std::size_t>(max_threads,
+									text.size() / ROSTER_CHUNK));
+
+	// chunks end after a line end, the last one at the end of the text
+	std::vector<Chunk> chunks(threads);
+	std::size_t start = 0;
+	for (unsigned i = 0; i < threads; i++)
+	{
+		std::size_t end = text.find('\n', text.size() / threads * (i + 1));
+		end = i + 1 == threads || end == std::string_view::npos ?
+				text.size() : std::max(end + 1, start);
+		chunks[i].text = text.substr(start, end - start);
+		start = end;
+	}
+
+	std::vector<std::thread> workers;
+	for (unsigned i = 1; i < threads; i++)
+		workers.emplace_back(parse_chunk, std::ref(chunks[i]));
+	parse_chunk(chunks[0]);
+	for (std::thread &th : workers)
+		th.join();
+
+	// line numbers of a chunk continue after the lines of the previous
+	std::size_t n_rows = 0, lines = 0;
+	for (const Chunk &c : chunks)
+		n_rows += c.rows.size();
+
+	rows.clear();
+	errors.clear();
+	rows.reserve(n_rows);
+	for (Chunk &c : chunks)
+	{
+		rows.insert(rows.end(), c.rows.begin(), c.rows.end());
+		for (Roster_error &err : c.errors)
+			errors.push_back(Roster_error{err.line + lines, err.msg});
+		lines += c.lines;
+	}
+}
+
+/**
+ * @brief Parses the lines of one chunk
+ * @param chunk Chunk with its text, rows and errors are filled
+ */
+void Roster::parse_chunk(Chunk &chunk)
+{
+	std::string_view text = chunk.text;
+	chunk.rows.reserve(text.size() / 16);
+
+	while (!text.empty())
+	{
+		std::size_t nl = text.find('\n');
+		std::string_view line = text.substr(0, nl);
+		text.remove_prefix(nl == std::string_view::npos ? text.size() : nl+1);
+		chunk.lines++;
+
+		Roster_row row;
+		if (const char *msg = parse_line(line, row))
+			chunk.errors.push_back(Roster_error{chunk.lines, msg});
+		else if (!row.name.empty())
+		{
+			chunk.rows.push_back(row);
+			chunk.row_lines.push_back(chunk.lines);
+		}
+	}
+
+	check_names(chunk);
+}
+
+/**
+ * @brief Validates the names of the rows of a chunk at once, rows with
+ *	a bad name become bad lines, bad lines stay in the order of lines
+ * @param chunk Parsed chunk
+ */
+void Roster::check_names(Chunk &chunk)
+{
+	std::size_t n = chunk.rows.size();
+	std::vector<std::string_view> names(n);
+	std::unique_ptr<bool[]> ok(new bool[n]);
+
+	for (std::size_t i = 0; i < n; i++)
+		names[i] = chunk.rows[i].name;
+	if (valid_names(names.data(), n, ok.get()) == n)
+		return;
+
+	std::vector<Roster_error> bad;
+	std::size_t kept = 0;
+	for (std::size_t i = 0; i < n; i++)
+	{
+		if (!ok[i])
+		{
+			bad.push_back(Roster_error{chunk.row_lines[i], "Player name can "
+							"contain only letters, digits and _@$*-"});
+			continue;
+		}
+		chunk.rows[kept] = chunk.rows[i];
+		chunk.row_lines[kept++] = chunk.row_lines[i];
+	}
+	chunk.rows.resize(kept);
+	chunk.row_lines.resize(kept);
+
+	std::vector<Roster_error> errors(chunk.errors.size() + bad.size());
+	std::merge(chunk.errors.begin(), chunk.errors.end(), bad.begin(),
+				bad.end(), errors.begin(),
+				[](const Roster_error &a, const Roster_error &b)
+				{
+					return a.line < b.line;
+				});
+	chunk.errors.swap(errors);
+}
+
+/**
+ * @brief Parses and validates one line, except the characters of the name
+ * @param line Line without its end
+ * @param row Output, the player, with an empty name for an empty line
+ * @return Error message, nullptr if the line is valid
+ */
+const char *Roster::parse_line(std::string_view line, Roster_row &row)
+{
+	std::string_view words[3];
+	unsigned cnt = 0;
+
+	for (std::size_t i = 0; i < line.size() && cnt < 3; )
+	{
+		while (i < line.size() && std::isspace(
+				static_cast<unsigned char>(line[i])))
+			i++;
+
+		std::size_t start = i;
+		while (i < line.size() && !std::isspace(
+				static_cast<unsigned char>(line[i])))
+			i++;
+
+		if (i > start)
+			words[cnt++] = line.substr(start, i - start);
+	}
+
+	row.name = words[0];
+	row.score = 0;
+	if (cnt == 3)
+		return "Too many words, expected <name> [<score>]";
+	if (row.name.size() > MAX_PNAME)
+		return "Player name too long, maximum 32 characters";
+	if (cnt < 2)
+		return nullptr;
+
+	std::string_view num = words[1];
+	bool plus = num[0] == '+';		// from_chars takes only a minus
+	if (plus)
+		num.remove_prefix(1);
+	if (num.empty() || (plus && num[0] == '-'))
+		return "Wrong format of score";
+
+	auto res = std::from_chars(num.data(), num.data() + num.size(),
+								row.score);
+	if (res.ec != std::errc() || res.ptr != num.data() + num.size())
+		return "Wrong format of score";
+	if (row.score > MAX_SCORE || row.score < MIN_SCORE)
+		return "Score out of range";
+
+	return nullptr;
+}
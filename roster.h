@@ -0,0 +1,69 @@
+/**
+ * @file roster.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Parser of roster files, lists of players for the bulk import
+ *	Line format: <name> [<score>], words separated by whitespace, empty
+ *	lines are skipped. The text is split into chunks at line ends, which
+ *	are parsed and validated in parallel, every chunk into its own rows,
+ *	rows are then in the order of the file. Rows point into the text.
+ *	Names of a chunk are validated in one call after its lines are split.
+ */
+
+#ifndef ROSTER_H
+#define ROSTER_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+const std::size_t ROSTER_CHUNK = 1u << 16;	///< Least text of a thread
+const unsigned ROSTER_SHOWN = 10;			///< Bad lines reported in full
+
+/**
+ * @brief Valid line of the roster
+ */
+struct Roster_row
+{
+	std::string_view name;		///< Player name, points into the text
+	int score;					///< Player score, 0 if not given
+};
+
+/**
+ * @brief Bad line of the roster
+ */
+struct Roster_error
+{
+	std::size_t line;			///< Number of the line, from 1
+	const char *msg;			///< What is wrong
+};
+
+/**
+ * @brief Rows and bad lines of a parsed roster
+ */
+class Roster
+{
+		/**
+		 * @brief Part of the text parsed by one thread
+		 */
+		struct Chunk
+		{
+			std::string_view text;
+			std::vector<Roster_row> rows;
+			std::vector<std::size_t> row_lines;	///< Lines of the rows
+			std::vector<Roster_error> errors;	///< Lines within the chunk
+			std::size_t lines = 0;				///< Lines of the chunk
+		};
+	public:
+		std::vector<Roster_row> rows;		///< Valid lines, in file order
+		std::vector<Roster_error> errors;	///< Bad lines, in file order
+		unsigned threads = 0;				///< Threads of the last parse
+
+		void parse(std::string_view text, unsigned max_threads);
+	private:
+		static void parse_chunk(Chunk &chunk);
+		static void check_names(Chunk &chunk);
+		static const char *parse_line(std::string_view line, Roster_row &row);
+};
+
+#endif	// include ROSTER_H
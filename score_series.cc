@@ -0,0 +1,325 @@
+/**
+ * @file score_series.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the time series of score changes
+ */
+
+#include "score_series.h"
+#include <algorithm>
+#include <chrono>
+
+
+/**
+ * @brief Appends a varint, 7 bits per byte, lowest first
+ * @param out Byte stream
+ * @param v Value
+ */
+static inline void put_varint(std::vector<unsigned char> &out,
+								std::uint64_t v)
+{
+	while (v >= 0x80)
+	{
+		out.push_back(static_cast<unsigned char>(v | 0x80));
+		v >>= 7;
+	}
+	out.push_back(static_cast<unsigned char>(v));
+}
+
+/**
+ * @brief Reads a varint
+ * @param p Position in the byte stream, moved after the value
+ * @return Value
+ */
+static inline std::uint64_t get_varint(const unsigned char *&p)
+{
+	std::uint64_t v = 0;
+	for (unsigned shift = 0; ; shift += 7)
+	{
+		unsigned char b = *p++;
+		v |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+		if (!(b & 0x80))
+			return v;
+	}
+}
+
+/**
+ * @brief Maps signed values to unsigned, small magnitudes to small values
+ * @param v Signed value
+ * @return 0, -1, 1, -2 .. as 0, 1, 2, 3 ..
+ */
+static inline std::uint64_t zigzag(std::int64_t v)
+{
+	return (static_cast<std::uint64_t>(v) << 1) ^
+			static_cast<std::uint64_t>(v >> 63);
+}
+
+/**
+ * @brief Inverse of zigzag
+ * @param v Unsigned value
+ * @return Signed value
+ */
+static inline std::int64_t unzigzag(std::uint64_t v)
+{
+	return static_cast<std::int64_t>(v >> 1) ^
+			-static_cast<std::int64_t>(v & 1);
+}
+
+/**
+ * @brief Decodes the checkpoint of a segment
+ * @param state Encoded ids and scores
+ * @param out Output, scores by ids
+ */
+static void read_state(const std::vector<unsigned char> &state,
+						std::unordered_map<std::uint32_t, int> &out)
+{
+	const unsigned char *p = state.data();
+	std::uint64_t n = get_varint(p);
+	std::uint32_t id = 0;
+
+	out.reserve(n);
+	for (std::uint64_t i = 0; i < n; i++)
+	{
+		id += get_varint(p);
+		out[id] = unzigzag(get_varint(p));
+	}
+}
+
+
+/**
+ * @brief Decodes the events of a segment
+ * @param s Segment
+ * @param f Called with the time, kind, id and delta of each event, in
+ *	order, until it returns false
+ */
+template<class F>
+void Score_series::each_event(const Segment &s, F f)
+{
+	const unsigned char *t = s.times.data();
+	const unsigned char *i = s.ids.data();
+	const unsigned char *d = s.deltas.data();
+	std::int64_t time = s.start;
+	std::int64_t id = 0;
+
+	for (std::uint32_t n = 0; n < s.count; n++)
+	{
+		time += unzigzag(get_varint(t));
+		id += unzigzag(get_varint(i));
+		std::uint64_t v = get_varint(d);
+		if (!f(time, static_cast<Series_kind>(v & 3),
+				static_cast<std::uint32_t>(id),
+				static_cast<int>(unzigzag(v >> 2))))
+			return;
+	}
+}
+
+/**
+ * @brief Starts a new segment with the scores of all the players, the
+ *	oldest segments are dropped if the memory is exceeded
+ * @param state Ids and scores of all the players, sorted by ids
+ */
+void Score_series::checkpoint(
+		const std::vector<std::pair<std::uint32_t, int>> &state)
+{
+	if (!segs.empty())		// closed, its columns do not grow any more
+	{
+		Segment &s = segs.back();
+		s.times.shrink_to_fit();
+		s.ids.shrink_to_fit();
+		s.deltas.shrink_to_fit();
+	}
+
+	segs.emplace_back();
+	Segment &s = segs.back();
+	s.start = s.last = now();
+	s.last_id = 0;
+	s.count = 0;
+	s.span = std::max<std::size_t>(SERIES_SPAN, state.size());
+
+	// ids ascend, so their differences are small
+	put_varint(s.state, state.size());
+	std::uint32_t id = 0;
+	for (const auto &[pl, score] : state)
+	{
+		put_varint(s.state, pl - id);
+		put_varint(s.state, zigzag(score));
+		id = pl;
+	}
+	s.state.shrink_to_fit();
+	total += s.bytes();
+
+	drop_old();
+}
+
+/**
+ * @brief Records an event in the current segment, which has to exist
+ * @param kind What happened
+ * @param id Id of the player, 0 for SK_CLEAR
+ * @param delta Change of the score
+ */
+void Score_series::record(Series_kind kind, std::uint32_t id, int delta)
+{
+	Segment &s = segs.back();
+	std::size_t before = s.times.size() + s.ids.size() + s.deltas.size();
+
+	std::int64_t t = now();		// clock can go back, differences are signed
+	put_varint(s.times, zigzag(t - s.last));
+	put_varint(s.ids, zigzag(static_cast<std::int64_t>(id) - s.last_id));
+	put_varint(s.deltas, zigzag(delta) << 2 | kind);
+	s.last = t;
+	s.last_id = id;
+	s.count++;
+
+	events++;
+	total += s.times.size() + s.ids.size() + s.deltas.size() - before;
+}
+
+/**
+ * @brief Remembers the name of a removed player, so past boards show him
+ * @param id Id of the player
+ * @param name Name of the player
+ */
+void Score_series::leave(std::uint32_t id, std::string_view name)
+{
+	Gone &g = gone[id];
+	g.name = name;
+	g.time = now();
+}
+
+/**
+ * @brief Rebuilds the scores of the players at a time, from the last
+ *	checkpoint before it
+ * @param time Milliseconds since the epoch
+ * @param out Output, ids and scores of the players, in no order
+ * @return False if the time is before the oldest checkpoint
+ */
+bool Score_series::state_at(std::int64_t time,
+							std::vector<std::pair<std::uint32_t, int>> &out)
+	const
+{
+	out.clear();
+	if (segs.empty() || time < segs[0].start)
+		return false;
+
+	auto seg = std::upper_bound(segs.begin(), segs.end(), time,
+					[](std::int64_t t, const Segment &s)
+					{
+						return t < s.start;
+					}) - 1;
+
+	std::unordered_map<std::uint32_t, int> scores;
+	read_state(seg->state, scores);
+	each_event(*seg, [&](std::int64_t t, Series_kind kind, std::uint32_t id,
+						int delta)
+	{
+		if (t > time)
+			return false;
+
+		switch (kind)
+		{
+			case SK_SCORE:
+				scores[id] += delta;
+				break;
+			case SK_JOIN:
+				scores[id] = delta;
+				break;
+			case SK_LEAVE:
+				scores.erase(id);
+				break;
+			case SK_CLEAR:
+				scores.clear();
+				break;
+		}
+		return true;
+	});
+
+	out.assign(scores.begin(), scores.end());
+	return true;
+}
+
+/**
+ * @brief Collects the events of a player since the oldest checkpoint,
+ *	removal of all the players is returned as his removal
+ * @param id Id of the player
+ * @param out Output, events in the order of time
+ */
+void Score_series::changes(std::uint32_t id, std::vector<Series_point> &out)
+	const
+{
+	out.clear();
+	if (segs.empty())
+		return;
+
+	// score at the start of the window, later only the events are needed
+	std::unordered_map<std::uint32_t, int> first;
+	read_state(segs[0].state, first);
+	auto it = first.find(id);
+	bool alive = it != first.end();
+	int score = alive ? it->second : 0;
+
+	for (const Segment &s : segs)
+	{
+		each_event(s, [&](std::int64_t t, Series_kind kind, std::uint32_t ev,
+							int delta)
+		{
+			if (kind == SK_CLEAR && alive)
+			{
+				out.push_back(Series_point{t, -score, 0, SK_LEAVE});
+				alive = false;
+				score = 0;
+			}
+			if (ev != id || kind == SK_CLEAR)
+				return true;
+
+			score = kind == SK_SCORE ? score + delta :
+					kind == SK_JOIN ? delta : 0;
+			alive = kind != SK_LEAVE;
+			out.push_back(Series_point{t, delta, score, kind});
+			return true;
+		});
+	}
+}
+
+/**
+ * @brief Name of a removed player
+ * @param id Id of the player
+ * @return Name, empty if the player was not removed in the window
+ */
+std::string_view Score_series::gone_name(std::uint32_t id) const
+{
+	auto it = gone.find(id);
+	return it == gone.end() ? std::string_view() : it->second.name;
+}
+
+/**
+ * @brief Current time of the events
+ * @return Milliseconds since the epoch
+ */
+std::int64_t Score_series::now()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Drops the oldest segments while the memory is exceeded, the
+ *	current one stays, names of players removed before the oldest
+ *	checkpoint are forgotten
+ */
+void Score_series::drop_old()
+{
+	bool dropped = false;
+	while (segs.size() > 1 && total > SERIES_BYTES)
+	{
+		total -= segs[0].bytes();
+		events -= segs[0].count;
+		segs.pop_front();
+		dropped = true;
+	}
+
+	if (!dropped)
+		return;
+
+	for (auto it = gone.begin(); it != gone.end(); )
+		it = it->second.time < segs[0].start ? gone.erase(it) : std::next(it);
+}
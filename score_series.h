@@ -0,0 +1,120 @@
+/**
+ * @file score_series.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Time series of the score changes of all the players, in memory
+ *	Every change is an event (time, player id, delta), events are stored
+ *	in columns, one byte stream for the times, ids and deltas each, every
+ *	value as a varint of the difference to the previous one, so an event
+ *	takes 3 to 4 bytes. Events are grouped into segments, each starts
+ *	with a checkpoint, the scores of all the players at its start, so the
+ *	board at any time is rebuilt from the checkpoint before it and the
+ *	events after, not from the beginning. Memory is bounded, the oldest
+ *	segments are dropped when a new one starts.
+ */
+
+#ifndef SCORE_SERIES_H
+#define SCORE_SERIES_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+const std::size_t SERIES_BYTES = 1u << 22;	///< Most memory of the events
+const std::uint32_t SERIES_SPAN = 4096;		///< Least events of a segment
+
+/**
+ * @brief What happened to the player
+ */
+enum Series_kind
+{
+	SK_SCORE,			///< Score changed by the delta
+	SK_JOIN,			///< Player added, the delta is his score
+	SK_LEAVE,			///< Player removed, the delta is minus his score
+	SK_CLEAR			///< All the players removed, no player
+};
+
+/**
+ * @brief Event of one player, as returned by the queries
+ */
+struct Series_point
+{
+	std::int64_t time;	///< Milliseconds since the epoch
+	int delta;			///< Change of the score
+	int score;			///< Score after the change
+	Series_kind kind;
+};
+
+/**
+ * @brief Score changes of the players over the recent time
+ */
+class Score_series
+{
+		/**
+		 * @brief Checkpoint with the events until the next one
+		 */
+		struct Segment
+		{
+			std::int64_t start;				///< Time of the checkpoint
+			std::int64_t last;				///< Time of the last event
+			std::uint32_t last_id;			///< Id of the last event
+			std::uint32_t count;			///< Number of events
+			std::uint32_t span;				///< Events until the next one
+			std::vector<unsigned char> state;	///< Ids and scores at start
+			std::vector<unsigned char> times;	///< Time differences
+			std::vector<unsigned char> ids;		///< Id differences
+			std::vector<unsigned char> deltas;	///< Deltas and kinds
+
+			std::size_t bytes() const
+			{
+				return state.size() + times.size() + ids.size() +
+						deltas.size();
+			}
+		};
+
+		/**
+		 * @brief Name of a removed player, kept while he can be shown
+		 */
+		struct Gone
+		{
+			std::string name;
+			std::int64_t time;				///< Time of the removal
+		};
+
+		std::deque<Segment> segs;			///< Oldest first
+		std::size_t total;					///< Bytes of all the segments
+		std::uint64_t events;				///< Events of all the segments
+		std::unordered_map<std::uint32_t, Gone> gone;	///< Names by ids
+	public:
+		Score_series(): total{0}, events{0} {}
+
+		bool need_checkpoint() const
+		{
+			return segs.empty() || segs.back().count >= segs.back().span;
+		}
+		void checkpoint(
+				const std::vector<std::pair<std::uint32_t, int>> &state);
+		void record(Series_kind kind, std::uint32_t id, int delta);
+		void leave(std::uint32_t id, std::string_view name);
+
+		bool state_at(std::int64_t time,
+					std::vector<std::pair<std::uint32_t, int>> &out) const;
+		void changes(std::uint32_t id, std::vector<Series_point> &out) const;
+		std::string_view gone_name(std::uint32_t id) const;
+
+		std::int64_t since() const { return segs.empty() ? 0 : segs[0].start; }
+		std::size_t bytes() const { return total; }
+		std::uint64_t size() const { return events; }
+
+		static std::int64_t now();
+	private:
+		template<class F>
+		static void each_event(const Segment &s, F f);
+		void drop_old();
+};
+
+#endif	// include SCORE_SERIES_H
@@ -8,19 +8,24 @@
  */
 
 #include "scoreboard.h"
+#include "snapshot.h"
+#include "file_map.h"
+#include "name_check.h"
+#include "roster.h"
+#include "history.h"
 #include <algorithm>
-#include <sstream>		// std::ostringstream
-#include <sys/ioctl.h>	// get terminal
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>		// strnlen
+#include <ctime>
 #include <unistd.h>
 
 
 /* ------------------------------------------------------------ */
 
 
-	// TODO mode file-saving if empty string
-//	if (!s_f.empty())		// TODO exceptions
-//		save_f.open(s_f, std::ios::out);	// initialize save file
-//
 //	if (!s_hf.empty())
 //		h_file.open(s_hf, std::ios::out);	// initialize history file
 
@@ -32,6 +37,8 @@
  */
 void Scoreboard::init_players(int num)
 {
+	Stat_scope st(STAT_MUTATION);
+
 	// number of available players to be created
 	int avail_plrs = max_players - players.size();
 
@@ -43,17 +50,29 @@ void Scoreboard::init_players(int num)
 		num = avail_plrs;
 	}
 
-	std::ostringstream aux;
+	const std::string base = "Player";
+	char aux[PNAME_LIMIT + 16];
+	Write_scope ws(*this);
+	players.reserve(players.size() + std::max(num, 0));
 
 	// init vector of players to plyrs number of players
 	for(int i = 1; i <= num; i++)
-	{	// optimized version of add_player() method
-		aux.str(std::string());				// clear aux
-		aux << "Player" << "(" << i << ")";
-		players[aux.str()] = 0;				// adding player
+	{	// optimized version of add_player() method, always with suffix
+		std::string_view name;
+		do {
+			name = std::string_view(aux, 
+						Suffix_index::format(aux, base, suffixes.take(base)));
+		} while (players.find(name) != NO_SLOT);
+
+		players.add(name, 0);				// adding player
+		log_op(Batch_op::ADDED, name);
+		journal.append(Journal::J_ADD, name, 0);
 	}
 
-	sort_scb();								// need to sort
+	if (batch)
+		rank_dirty = true;
+	else
+		sort_scb();							// need to sort
 
 	std::cout << "Initialized with " << num << " players." << std::endl;
 }
@@ -69,17 +88,43 @@ void Scoreboard::set_max_players(int num)
 	if (num < 0 || num > USHRT_MAX)	// hard limit 
 		report_err("Incorrect number of maximum players", void());
 
-	int i = players.size()-1;	// index
-	while (i > num)			// remove players above limit
+	if (batch)		// ranks of the removed players would not be current
+		report_err("Player limit cannot be changed inside a batch", void());
+
+	// remove the lowest ranked players above limit
+	bool removed = players.size() > static_cast<unsigned int>(num);
+	while (players.size() > static_cast<unsigned int>(num))
+		rm_player(static_cast<int>(players.size()));	// TODO range delete
+
+	if (removed)	// undo would add players over the limit
+		forget_steps();
+
 	{
-		rm_player(i);		// TODO range delete
-		i--;
+		Write_scope ws(*this);
+		max_players = num;
 	}
-
-	max_players = num;
+	journal.append(Journal::J_LIMIT, {}, num);
 	std::cout << "Player limit set to: " << max_players << std::endl;
 }
 
+/**
+ * @brief Sets how many steps of mutations can be undone
+ * @param num Number of steps, 0 disables undo and drops the steps
+ */
+void Scoreboard::set_undo_depth(int num)
+{
+	debug_info();
+
+	if (num < 0 || num > USHRT_MAX)
+		report_err("Incorrect number of undo steps", void());
+
+	undo_max = num;
+	for (Step_log *log : {&undo_log, &redo_log})
+		while (log->steps.size() > undo_max)
+			log->drop_oldest();
+	std::cout << "Undo depth set to: " << undo_max << std::endl;
+}
+
 /**
  * @brief Adds a player to the scoreboard
  * 	Checks player limit, uniqueness of player's name, if not unique, then
@@ -87,30 +132,26 @@ void Scoreboard::set_max_players(int num)
  * @param name Name of the player
  * @param score Score of the player
  */
-void Scoreboard::add_player(const std::string &name, int score)
+void Scoreboard::add_player(std::string_view name, int score)
 {
 	debug_info();
 
 	if (players.size() >= max_players)		// checking limit of players
 		report_err("Cannot create another player, at limit!", void());
 	
+	if (name.empty())						// length 0 marks a free slot
+		report_err("Player name cannot be empty", void());
+
 	if (name.length() > MAX_PNAME)			// max limit of chars exceeded
 		report_err("Player name too long, maximum 32 characters!", void());
 
-	std::ostringstream aux;
-	aux << name;
-	// checking uniqueness of player's name
-	std::map<std::string, int>::iterator it = players.find(name);
-	for (int i = 1; it != players.end(); i++)
-	{
-		aux.str(std::string());				// clear aux
-		aux << name << "(" << i << ")";		// max (65534)
-		it = players.find(aux.str());
-	}
+	if (!valid_name(name))					// also no '#' of id references
+		report_err("Player name can contain only letters, digits and "
+					"_@$*-", void());
 
-	players[aux.str()] = score;				// adding player
+	char aux[PNAME_LIMIT + 16];
 
-	sort_scb();								// need to sort
+	insert_player(unique_name(name, aux), score);
 }
 
 /**
@@ -121,73 +162,70 @@ void Scoreboard::rm_player(int rank)
 {
 	debug_info();
 	
-	// use exceptions TODO
-	if (rank < 1 || (static_cast<unsigned int>(rank) > players.size()))
-		report_err("Incorrect player rank", void());
-	
-	std::vector<std::pair<std::string, int>>::iterator it = 
-		std::next(pl_sort.begin(), rank-1);
+	Pl_slot pl = get_player(rank);	// checking rank
+	if (pl == NO_SLOT)
+		return;
 	
-	players.erase(it->first);
-	pl_sort.erase(it);						// TODO sort again?? or only?
+	erase_player(pl);
 }
 
 /**
  * @brief Removes a player with a certain name
  * @param Name of the player to be removed
  */
-void Scoreboard::rm_player(const std::string &name)
+void Scoreboard::rm_player(std::string_view name)
 {
 	debug_info();
 
 	if (name.empty())
 		return;
 
-	Pl_it it = players.find(name);
-	if (it != players.end())
+	Pl_slot pl = players.find(name);
+	if (pl != NO_SLOT)
 	{
-		players.erase(it);
-		sort_scb();
+		erase_player(pl);
 		return;
 	}
 
 	report_war("Player with that name does not exist");
 }
 
+/**
+ * @brief Removes a player with a certain id
+ * @param id Id of the player to be removed
+ */
+void Scoreboard::rm_player(Pl_id id)
+{
+	debug_info();
+
+	Pl_slot pl = get_player(id);
+	if (pl == NO_SLOT)
+		report_err("Player with that id does not exist", void());
+
+	erase_player(pl);
+}
+
 /**
  * @brief Renames player defined by his rank to new_name. No empty string
  *	and maximally 32 characters long string.
  * @param rank Rank of the player whoose name will be changed
  * @param new_name New name of the player
  */
-void Scoreboard::rename_player(int rank, const std::string &new_name)
+void Scoreboard::rename_player(int rank, std::string_view new_name)
 {
 	debug_info();
 
-	if (new_name.empty() || new_name.length() > MAX_PNAME)
+	if (new_name.empty() || new_name.length() > MAX_PNAME || 
+		!valid_name(new_name))
 		report_err("Incorrect new name specified", void());
 
-	Pl_it it = get_player(rank);	// checking rank
-	if (it == players.end())
+	Pl_slot pl = get_player(rank);	// checking rank
+	if (pl == NO_SLOT)
 		report_err("Player with that rank does not exist", void());
 
 	// checking uniqueness of player's name
-	std::ostringstream aux;
-	aux << new_name;
-	std::map<std::string, int>::iterator a_it = players.find(new_name);
-	for (int i = 1; a_it != players.end(); i++)
-	{
-		aux.str(std::string());				// clear aux
-		aux << new_name << "(" << i << ")";
-		a_it = players.find(aux.str());
-	}
-
-	// overwrite key
-	auto nodeHandler = players.extract(it);	// detaches node
-	nodeHandler.key() = aux.str();			// changes key
-	players.insert(std::move(nodeHandler));	// inserts back the node
-
-	sort_scb();								// need to sort
+	char aux[PNAME_LIMIT + 16];
+	move_player(pl, unique_name(new_name, aux));
 }
 
 /**
@@ -195,35 +233,44 @@ void Scoreboard::rename_player(int rank, const std::string &new_name)
  * @param name Name of the player to be renamed
  * @param new_name A new name for the player
  */
-void Scoreboard::rename_player(const std::string &name, 
-								const std::string &new_name)
+void Scoreboard::rename_player(std::string_view name,
+								std::string_view new_name)
 {
 	debug_info();
 
-	if (new_name.empty() || new_name.length() > MAX_PNAME)
+	if (new_name.empty() || new_name.length() > MAX_PNAME || 
+		!valid_name(new_name))
 		report_err("Incorrect new name specified", void());
 
-	Pl_it it = get_player(name);		// checking name
-	if (it == players.end())
+	Pl_slot pl = get_player(name);		// checking name
+	if (pl == NO_SLOT)
 		report_err("Player with that name does not exist", void());
 
 	// checking uniqueness of player's name
-	std::ostringstream aux;
-	aux << new_name;
-	std::map<std::string, int>::iterator a_it = players.find(new_name);
-	for (int i = 1; a_it != players.end(); i++)
-	{
-		aux.str(std::string());				// clear aux
-		aux << new_name << "(" << i << ")";
-		a_it = players.find(aux.str());
-	}
+	char aux[PNAME_LIMIT + 16];
+	move_player(pl, unique_name(new_name, aux));
+}
+
+/**
+ * @brief Renames player defined by his id to a new_name, id stays the same
+ * @param id Id of the player to be renamed
+ * @param new_name A new name for the player
+ */
+void Scoreboard::rename_player(Pl_id id, std::string_view new_name)
+{
+	debug_info();
+
+	if (new_name.empty() || new_name.length() > MAX_PNAME || 
+		!valid_name(new_name))
+		report_err("Incorrect new name specified", void());
 
-	// overwrite key
-	auto nodeHandler = players.extract(it);	// detaches node
-	nodeHandler.key() = aux.str();			// changes key
-	players.insert(std::move(nodeHandler));	// inserts back the node
+	Pl_slot pl = get_player(id);		// checking id
+	if (pl == NO_SLOT)
+		report_err("Player with that id does not exist", void());
 
-	sort_scb();								// need to sort
+	// checking uniqueness of player's name
+	char aux[PNAME_LIMIT + 16];
+	move_player(pl, unique_name(new_name, aux));
 }
 
 /**
@@ -235,8 +282,8 @@ void Scoreboard::add_pscore(int rank, int num)
 {
 	debug_info();
 
-	auto it = get_player(rank);
-	if (it == players.end())
+	Pl_slot pl = get_player(rank);
+	if (pl == NO_SLOT)
 		report_err("Player with that rank does not exist", void());
 
 	if (num > MAX_SCORE)		
@@ -244,9 +291,7 @@ void Scoreboard::add_pscore(int rank, int num)
 	else if (num < MIN_SCORE)
 		num = MIN_SCORE;		// automatically sets to lower limit
 
-	it->second += num;
-
-	sort_scb();					// need to sort again
+	set_score(pl, players.score(pl) + num);
 }
 
 /**
@@ -254,12 +299,12 @@ void Scoreboard::add_pscore(int rank, int num)
  * @param name Name of the player
  * @param num Number added to the player's score (can be negative)
  */
-void Scoreboard::add_pscore(const std::string &name, int num)
+void Scoreboard::add_pscore(std::string_view name, int num)
 {
 	debug_info();
 
-	auto it = get_player(name);
-	if (it == players.end())
+	Pl_slot pl = get_player(name);
+	if (pl == NO_SLOT)
 		report_err("Player with that name does not exist", void());
 
 	if (num > MAX_SCORE)		
@@ -267,9 +312,28 @@ void Scoreboard::add_pscore(const std::string &name, int num)
 	else if (num < MIN_SCORE)
 		num = MIN_SCORE;		// automatically sets to lower limit
 
-	it->second += num;
+	set_score(pl, players.score(pl) + num);
+}
+
+/**
+ * @brief Adds a number to a player's score, identified by his id
+ * @param id Id of the player
+ * @param num Number added to the player's score (can be negative)
+ */
+void Scoreboard::add_pscore(Pl_id id, int num)
+{
+	debug_info();
+
+	Pl_slot pl = get_player(id);
+	if (pl == NO_SLOT)
+		report_err("Player with that id does not exist", void());
+
+	if (num > MAX_SCORE)		
+		num = MAX_SCORE;		// automatically sets to upper limit
+	else if (num < MIN_SCORE)
+		num = MIN_SCORE;		// automatically sets to lower limit
 
-	sort_scb();					// need to sort again
+	set_score(pl, players.score(pl) + num);
 }
 
 /**
@@ -280,66 +344,609 @@ void Scoreboard::reset_pscore(int rank)
 {
 	debug_info();
 
-	auto it = get_player(rank);
-	if (it == players.end())
+	Pl_slot pl = get_player(rank);
+	if (pl == NO_SLOT)
 		report_err("Player with that rank does not exist", void());
 
-	it->second = 0;
-
-	sort_scb();					// need to sort again
+	set_score(pl, 0);
 }
 
 /**
  * @brief Resets player's score to 0
  * @param name Player's name
  */
-void Scoreboard::reset_pscore(const std::string &name)
+void Scoreboard::reset_pscore(std::string_view name)
 {
 	debug_info();
 
-	auto it = get_player(name);
-	if (it == players.end())
+	Pl_slot pl = get_player(name);
+	if (pl == NO_SLOT)
 		report_err("Player with that name does not exist", void());
 
-	it->second = 0;
+	set_score(pl, 0);
+}
+
+/**
+ * @brief Resets player's score to 0
+ * @param id Player's id
+ */
+void Scoreboard::reset_pscore(Pl_id id)
+{
+	debug_info();
+
+	Pl_slot pl = get_player(id);
+	if (pl == NO_SLOT)
+		report_err("Player with that id does not exist", void());
 
-	sort_scb();					// need to sort again
+	set_score(pl, 0);
 }
-	
+
 /**
- * @brief TODO
+ * @brief Applies a batch of queued score events as one mutation, events
+ *	of a player are summed, so he is re-ranked once, if many players are
+ *	changed, the ranking is rebuilt once instead, errors are not reported
+ * @param evs Score events, in the order they were queued
+ * @param n Number of events
+ * @return Number of events of no existing player, they are skipped
  */
-bool Scoreboard::save_to_file(std::ostream file)
+std::size_t Scoreboard::apply_scores(const Score_event *evs, std::size_t n)
 {
 	debug_info();
-	
-	(void)file;
 
-	return false;
+	std::size_t missed = 0;
+	sums.resize(players.slots(), 0);
+	touched.clear();
+
+	for (std::size_t i = 0; i < n; i++)
+	{
+		Pl_slot pl = evs[i].id.num ? get_player(evs[i].id) :
+										get_player(evs[i].get_name());
+		if (pl == NO_SLOT)
+		{
+			missed++;
+			continue;
+		}
+
+		// each event is limited alone, same as add_pscore
+		int num = std::clamp<int>(evs[i].num, MIN_SCORE, MAX_SCORE);
+		if (!sums[pl])			// listed again if it was summed to 0 before
+			touched.push_back(pl);
+		sums[pl] += num;
+	}
+
+	Write_scope ws(*this);
+	bool rebuild = !batch && 4 * touched.size() > players.size();
+	for (Pl_slot pl : touched)
+	{
+		int num = sums[pl];
+		sums[pl] = 0;
+		if (!num)				// no change, or listed twice
+			continue;
+
+		if (!rebuild)
+		{
+			update_score(pl, players.score(pl) + num);
+			continue;
+		}
+
+		Stat_scope st(STAT_MUTATION);
+		log_op(Batch_op::SCORED, players.name(pl), players.score(pl));
+		journal.append(Journal::J_SCORE, players.name(pl),
+						players.score(pl) + num);
+		players.set_score(pl, players.score(pl) + num);
+	}
+
+	if (rebuild)
+		sort_scb();
+
+	return missed;
 }
 
 /**
- * @brief TODO
+ * @brief Saves the scoreboard to a binary snapshot, see snapshot.h
+ * @param path Path of the snapshot file
+ * @return True on success
  */
-bool Scoreboard::load_players_from_file(std::istream file)
+bool Scoreboard::save_to_file(const std::string &path)
 {
 	debug_info();
-	
-	(void)file;
 
-	return false;
+	if (!write_snapshot(path, 0))
+		return false;
+
+	std::cout << "Saved " << players.size() << " players to " << path <<
+		std::endl;
+	return true;
+}
+
+/**
+ * @brief Saves the scoreboard to a binary snapshot from a child process,
+ *	which has a copy-on-write image of the board, the parent goes on right
+ *	after the fork, see snap_fork.h
+ * @param path Path of the snapshot file
+ * @return Pid of the child, -1 on error, errno is set if fork failed
+ */
+pid_t Scoreboard::save_forked(const std::string &path)
+{
+	debug_info();
+
+	if (batch)		// ranking is not current
+		report_err("Cannot save inside a batch, commit it first", -1);
+
+	// a failed fork is reported by the caller, it may be another thread
+	pid_t pid = ::fork();
+	if (pid < 0)
+		return -1;
+
+	// only this thread exists in the child, it owns the board, nothing
+	// of the parent is flushed or destroyed by the child
+	if (!pid)
+		::_exit(write_snapshot(path, 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+
+	return pid;
+}
+
+/**
+ * @brief Replaces the scoreboard with a binary snapshot
+ * @param path Path of the snapshot file
+ * @return True on success
+ */
+bool Scoreboard::load_from_file(const std::string &path)
+{
+	debug_info();
+
+	std::uint32_t gen;
+	if (!read_snapshot(path, gen))
+		return false;
+
+	std::cout << "Loaded " << players.size() << " players from " << path <<
+		std::endl;
+
+	// journal has to start from the loaded players
+	if (journal.is_open())
+		return compact();
+
+	return true;
+}
+
+/**
+ * @brief Writes a binary snapshot, see snapshot.h
+ * @param path Path of the snapshot file
+ * @param gen Generation of the journal the snapshot includes
+ * @return True on success
+ */
+bool Scoreboard::write_snapshot(const std::string &path, std::uint32_t gen)
+{
+	debug_info();
+
+	if (batch)		// ranking is not current
+		report_err("Cannot save inside a batch, commit it first", false);
+
+	Snap_writer snap;
+	snap.begin(players.size(), show_max, max_players, gen,
+				players.next_id().num);
+	ranking.for_each([&](int, Pl_slot pl)
+	{
+		snap.add(players.name(pl), players.score(pl), players.id(pl).num);
+	});
+
+	return snap.write(path);
+}
+
+/**
+ * @brief Replaces the scoreboard with a binary snapshot, the file is
+ *	mapped to the memory and its records are used directly
+ * @param path Path of the snapshot file
+ * @param gen Output, generation of the journal the snapshot includes
+ * @return True on success
+ */
+bool Scoreboard::read_snapshot(const std::string &path, std::uint32_t &gen)
+{
+	debug_info();
+
+	if (batch)
+		report_err("Cannot load inside a batch, commit it first", false);
+
+	Snap_map snap;
+	if (!snap.open(path))
+		return false;
+
+	const Snap_header &hdr = snap.header();
+	if (hdr.count > H_PLIMIT)
+		report_err("Snapshot " << path << " has too many players", false);
+
+	// a bad record fails the load before the board is replaced, ids are
+	// below the next one, which is below the limit of ids
+	if (hdr.next_id > ID_LIMIT)
+		report_err("Snapshot " << path << " has ids out of range", false);
+
+	for (std::uint32_t i = 0; i < hdr.count; i++)
+	{
+		Snap_record rec = snap.record(i);
+		if (!rec.name[0])
+			report_err("Snapshot " << path << " has a player without a name",
+						false);
+		if (rec.id && rec.id >= hdr.next_id)
+			report_err("Snapshot " << path << " has a player id " << rec.id <<
+						" out of range", false);
+	}
+
+	rm_players();
+	Write_scope ws(*this);
+
+	// ids are kept, players of older snapshots get new ones
+	players.set_next_id(Pl_id{hdr.next_id});
+
+	// records are in the order of ranking, the index is built directly
+	std::vector<Pl_slot> sorted;
+	sorted.reserve(hdr.count);
+	bool ordered = true;
+
+	for (std::uint32_t i = 0; i < hdr.count; i++)
+	{
+		Snap_record rec = snap.record(i);
+		std::string_view name(rec.name, strnlen(rec.name, PNAME_LIMIT));
+		if (players.find(name) != NO_SLOT)
+		{
+			report_war("Duplicate player " << name << " in the snapshot");
+			continue;
+		}
+
+		Pl_slot pl = players.add(name, rec.score, Pl_id{rec.id});
+		if (!sorted.empty() && !Rank_index::higher(
+				players.score(sorted.back()), players.name(sorted.back()),
+				rec.score, name))
+			ordered = false;
+		sorted.push_back(pl);
+	}
+
+	if (ordered)
+	{
+		ranking.build(sorted);
+		view_dirty = true;
+	}
+	else
+		sort_scb();
+
+	if (hdr.show_max == HGHT_LIMIT || 
+		(hdr.show_max >= 0 && hdr.show_max <= USHRT_MAX))
+		show_max = hdr.show_max;
+	max_players = std::max<unsigned int>(
+		std::min<unsigned int>(hdr.max_players, H_PLIMIT), players.size());
+	gen = hdr.generation;
+	forget_steps();				// old players are not logged
+
+	return true;
+}
+
+/**
+ * @brief Opens a journal of mutations, restores the scoreboard from its
+ *	last compacted snapshot ("<path>.snap") and the journal records
+ * @param path Path of the journal file
+ * @param every Synchronize the journal after this many mutations
+ * @param ms Synchronize the journal at least every ms milliseconds
+ * @return True on success
+ */
+bool Scoreboard::open_journal(const std::string &path, unsigned every,
+								unsigned ms)
+{
+	debug_info();
+
+	if (journal.is_open())
+		report_err("Journal is already opened", false);
+
+	std::uint32_t snap_gen = 0;
+	std::string snap = path + ".snap";
+	if (!access(snap.c_str(), F_OK) && !read_snapshot(snap, snap_gen))
+		return false;
+
+	// records of older generations are already in the snapshot
+	std::uint32_t gen;
+	std::size_t valid;
+	unsigned count = 0;
+	bool ok = Journal::read(path, gen, valid, 
+							[&](const Journal::Record &rec)
+							{
+								if (gen >= snap_gen)
+								{
+									replay(rec);
+									count++;
+								}
+							});
+	if (!ok)
+		return false;
+
+	if (gen < snap_gen || !valid)
+	{
+		gen = snap_gen;
+		valid = 0;
+	}
+
+	if (!journal.open(path, valid, gen, every, ms))
+		return false;
+
+	if (batch)		// crashed inside a batch, it was never committed
+	{
+		report_war("Unfinished batch in the journal is aborted");
+		end_batch(false);
+		journal.append(Journal::J_ABORT);
+	}
+	forget_steps();				// undo starts with the restored board
+
+	std::cout << "Journal " << path << " opened, " << players.size() << 
+		" players restored, " << count << " records replayed" << std::endl;
+	return true;
+}
+
+/**
+ * @brief Folds the journal into a new snapshot and empties the journal
+ * @return True on success
+ */
+bool Scoreboard::compact()
+{
+	debug_info();
+
+	if (!journal.is_open())
+		report_err("No journal opened", false);
+
+	// generation of the snapshot marks journal records it includes, so a
+	// crash before the journal is emptied does not replay them twice
+	std::uint32_t gen = journal.generation() + 1;
+	std::string snap = journal.get_path() + ".snap";
+	if (!write_snapshot(snap, gen) || !journal.reset(gen))
+		return false;
+
+	std::cout << "Journal compacted into " << snap << std::endl;
+	return true;
+}
+
+/**
+ * @brief Applies a journaled mutation, names are already resolved
+ * @param rec Journal record
+ */
+void Scoreboard::replay(const Journal::Record &rec)
+{
+	// names were checked by the commands, a damaged record is skipped
+	std::string_view added = rec.op == Journal::J_ADD ||
+								rec.op == Journal::J_RESTORE ? rec.name :
+							rec.op == Journal::J_RENAME ? rec.name2 : "-";
+	if (added.empty() || added.size() > PNAME_LIMIT)
+		report_err("Journal record with a bad player name skipped", void());
+
+	Pl_slot pl = players.find(rec.name);
+
+	switch (rec.op)
+	{
+		case Journal::J_ADD:
+			if (pl != NO_SLOT)
+				set_score(pl, rec.num);
+			else
+				insert_player(rec.name, rec.num);
+			break;
+		case Journal::J_RESTORE:
+		{
+			// a bad id is not given, the player gets a new one
+			Pl_id id{0};
+			std::from_chars(rec.name2.data(),
+							rec.name2.data() + rec.name2.size(), id.num);
+			if (pl != NO_SLOT)
+				set_score(pl, rec.num);
+			else
+				restore_player(rec.name, rec.num, id);
+			break;
+		}
+		case Journal::J_REMOVE:
+			if (pl != NO_SLOT)
+				erase_player(pl);
+			break;
+		case Journal::J_RENAME:
+			if (pl != NO_SLOT && players.find(rec.name2) == NO_SLOT)
+				move_player(pl, rec.name2);
+			break;
+		case Journal::J_SCORE:
+			if (pl != NO_SLOT)
+				set_score(pl, rec.num);
+			break;
+		case Journal::J_RESET_ALL:
+			reset_score();
+			break;
+		case Journal::J_REMOVE_ALL:
+			rm_players();
+			break;
+		case Journal::J_LIMIT:
+			if (rec.num >= 0 && rec.num <= H_PLIMIT)
+			{
+				Write_scope ws(*this);
+				max_players = rec.num;
+			}
+			break;
+		case Journal::J_SHOW:		// same bounds as set_show_max
+			if (rec.num < 0 || rec.num > USHRT_MAX)
+				report_err("Journal record with a bad show limit skipped",
+							void());
+			{
+				Write_scope ws(*this);
+				show_max = rec.num;
+			}
+			break;
+		case Journal::J_BEGIN:
+			if (!batch)
+				start_batch();
+			break;
+		case Journal::J_COMMIT: case Journal::J_ABORT:
+			if (batch)
+				end_batch(rec.op == Journal::J_COMMIT);
+			break;
+		default:
+			report_war("Unknown journal record " << rec.op);
+	}
+}
+
+/**
+ * @brief Adds the players listed in a roster file, see roster.h, the file
+ *	is mapped and parsed by chunks in parallel, bad lines are skipped and
+ *	reported with their numbers, names are made unique in the order of the
+ *	file and the players are ranked at once, times of the stages are shown
+ * @param path Path of the roster file
+ * @return True if the file was read
+ */
+bool Scoreboard::load_players_from_file(const std::string &path)
+{
+	debug_info();
+
+	using clock = std::chrono::steady_clock;
+	auto us = [](clock::time_point a, clock::time_point b)
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(b - a)
+					.count();
+	};
+
+	clock::time_point t_start = clock::now();
+	File_map file;
+	if (!file.open(path))
+		return false;
+
+	clock::time_point t_map = clock::now();
+	Roster roster;
+	roster.parse(file.text(), 0);
+
+	clock::time_point t_parse = clock::now();
+	for (unsigned i = 0; i < roster.errors.size() && i < ROSTER_SHOWN; i++)
+		report_war("Line " << roster.errors[i].line << " skipped: " <<
+					roster.errors[i].msg);
+	if (roster.errors.size() > ROSTER_SHOWN)
+		report_war(roster.errors.size() - ROSTER_SHOWN <<
+					" more bad lines skipped");
+
+	std::size_t avail = max_players - std::min(max_players, players.size());
+	std::size_t num = roster.rows.size();
+	if (num > avail)
+	{
+		report_war("Only " << avail << " players will be added, change this "
+					"limit later: set plimit N, where N is the new limit");
+		num = avail;
+	}
+
+	// names are made unique in the order of the file, then ranked at once
+	char aux[PNAME_LIMIT + 16];
+	clock::time_point t_store, t_rank;
+	{
+		Write_scope ws(*this);
+		{
+			Stat_scope st(STAT_MUTATION);
+			players.reserve(players.size() + num);
+			for (std::size_t i = 0; i < num; i++)
+			{
+				std::string_view name = unique_name(roster.rows[i].name, aux);
+				players.add(name, roster.rows[i].score);
+				log_op(Batch_op::ADDED, name);
+				journal.append(Journal::J_ADD, name, roster.rows[i].score);
+			}
+		}
+
+		t_store = clock::now();
+		if (batch)
+			rank_dirty = true;
+		else if (num)
+			sort_scb();
+		t_rank = clock::now();
+	}
+
+	std::cout << "Loaded " << num << " players from " << path << ", " <<
+		roster.errors.size() << " bad lines skipped (map " <<
+		us(t_start, t_map) << " us, parse " << us(t_map, t_parse) <<
+		" us on " << roster.threads << " threads, store " <<
+		us(t_parse, t_store) << " us, rank " << us(t_store, t_rank) <<
+		" us)" << std::endl;
+	return true;
 }
 
 /**
- * @brief TODO
+ * @brief Merges the tables of a history file, see history.h, into the
+ *	scoreboard, the file is mapped and read once, a player of a row gets
+ *	its score, players not on the board are added up to the player limit,
+ *	later rows of a player win, bad rows are skipped and reported with
+ *	their line numbers, the players are ranked at once
+ * @param path Path of the history file
+ * @return True if the file was read
  */
-bool Scoreboard::load_history(std::istream file)
+bool Scoreboard::load_history(const std::string &path)
 {
 	debug_info();
 
-	(void)file;
+	using clock = std::chrono::steady_clock;
+	auto us = [](clock::time_point a, clock::time_point b)
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(b - a)
+					.count();
+	};
+
+	clock::time_point t_start = clock::now();
+	File_map file;
+	if (!file.open(path))
+		return false;
+
+	clock::time_point t_map = clock::now(), t_merge, t_rank;
+	std::size_t rows = 0, added = 0, changed = 0, bad = 0, over = 0;
+	{
+		Write_scope ws(*this);
+		{
+			Stat_scope st(STAT_MUTATION);
+			History_reader hist(file.text());
+			History_row row;
+			const char *msg;
+
+			while (hist.next(row, msg))
+			{
+				if (msg)
+				{
+					if (++bad <= HISTORY_SHOWN)
+						report_war("Line " << hist.line() << " skipped: " <<
+									msg);
+					continue;
+				}
+				rows++;
+
+				Pl_slot pl = players.find(row.name);
+				if (pl == NO_SLOT && players.size() >= max_players)
+					over++;
+				else if (pl == NO_SLOT)
+				{
+					players.add(row.name, row.score);
+					log_op(Batch_op::ADDED, row.name);
+					journal.append(Journal::J_ADD, row.name, row.score);
+					added++;
+				}
+				else if (players.score(pl) != row.score)
+				{
+					log_op(Batch_op::SCORED, row.name, players.score(pl));
+					journal.append(Journal::J_SCORE, row.name, row.score);
+					players.set_score(pl, row.score);
+					changed++;
+				}
+			}
+		}
+
+		t_merge = clock::now();
+		if (batch)
+			rank_dirty = true;
+		else if (added || changed)
+			sort_scb();
+		t_rank = clock::now();
+	}
 
-	return false;
+	if (bad > HISTORY_SHOWN)
+		report_war(bad - HISTORY_SHOWN << " more bad lines skipped");
+	if (over)
+		report_war(over << " players were not added, change this limit "
+					"later: set plimit N, where N is the new limit");
+
+	std::cout << "Loaded " << rows << " rows from " << path << ", " <<
+		added << " players added, " << changed << " scores changed, " <<
+		bad << " bad lines skipped (map " << us(t_start, t_map) <<
+		" us, merge " << us(t_map, t_merge) << " us, rank " <<
+		us(t_merge, t_rank) << " us)" << std::endl;
+	return true;
 }
 
 /**
@@ -358,54 +965,693 @@ bool Scoreboard::load_history(std::istream file)
 void Scoreboard::print(std::ostream & strm)
 {
 	debug_info();
+	Stat_scope st(STAT_RENDER);
 
-	struct winsize w;
-	ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
+	// layouts are rebuilt only if the terminal width changed
+	Table_render &render = &strm == &std::cout ? this->render : file_render;
+	if (&strm == &std::cout)
+		render.set_width(Table_render::term_width());
 
-	// printing header TODO consider using std AFTER to check any problems
-	strm << " " << std::string(w.ws_col-2, '_') << std::endl <<
-		"| RANK   | PLAYER NAME " <<
-		std::string(w.ws_col-WIN_PADDING, ' ') << "| SCORE |" << std::endl;
+	// only the first show_max players are visited, the cost does not
+	// depend on the number of players below them
+	unsigned limit = show_max == HGHT_LIMIT ? players.size() : show_max;
 
-	LINE_BREAK;
+	// whole table is rendered to one buffer and written at once
+	render.begin();
+	unsigned shown = 0;
 
-	int i = 1;
-	for (auto it = pl_sort.begin(); it != pl_sort.end(); it++)
+	if (batch)		// ranking before the batch, without removed players
+	{
+		for (unsigned i = 0; i < batch_view.size() && shown < limit; i++)
+		{
+			if (!batch_rank[batch_view[i]])
+				continue;
+			render.row(i+1, players.name(batch_view[i]),
+						players.score(batch_view[i]));
+			shown++;
+		}
+
+		report_war("Batch in progress, ranking is updated on commit");
+	}
+	else
 	{
-		strm << "| " << i;
-		// just one or two digits
-		(i < 100) ? strm << ".\t | " : strm <<  ".\t| ";
-
-		strm << it->first << " " << 
-			std::string(w.ws_col-21-(it->first).length(), ' ') << "| " << 
-			it->second << "\t|" << std::endl;
-		LINE_BREAK;
-		i++;
+		ranking.for_each([&](int i, Pl_slot pl)
+		{
+			render.row(i, players.name(pl), players.score(pl));
+			shown++;
+		}, limit);
 	}
+	scb_stats.count(STAT_ROWS, shown);
 
-	// TODO FIX TABS
+	strm.write(render.data(), render.size());
+	strm.flush();
 }
 
 /**
- * @brief Sorts the scoreboard players based on their score using
- *	set structure descending and aplhabetically when scores match
+ * @brief Lists players by the start of their names, or by a pattern of
+ *	the whole name, '?' is any char and '%' any chars, the first players
+ *	in the order of names are shown with their rank and score
+ * @param pattern Prefix or pattern
  */
-void Scoreboard::sort_scb()
+void Scoreboard::find_players(std::string_view pattern)
 {
 	debug_info();
+	Stat_scope st(STAT_LOOKUP);
+
+	if (pattern.size() > TRIE_PATTERN)
+		report_err("Pattern too long, maximum 63 characters", void());
+
+	std::vector<Pl_slot> found;
+	std::size_t total = players.prefixes().find(pattern, FIND_SHOWN, found);
 
-	pl_sort.clear();
+	render.set_width(Table_render::term_width());
+	render.begin();
+	for (Pl_slot pl : found)
+		render.row(rank_of(pl), players.name(pl), players.score(pl));
+	std::cout.write(render.data(), render.size());
 
-	// copying to the vector from map
-	std::copy(players.begin(), players.end(),
-		std::back_inserter<std::vector<std::pair<std::string,
-													int>>>(pl_sort));
-	// sorting the vector based on my rule
-	std::sort(pl_sort.begin(), pl_sort.end(), 
-				[](std::pair<std::string, int> const &a, 
-					std::pair<std::string, int> const &b)
-					{
-						return a.second != b.second ? a.second > b.second :
-											a.first < b.first;
-					});
+	std::cout << total << (total == 1 ? " player matches" :
+							" players match");
+	if (total > found.size())
+		std::cout << ", first " << found.size() << " shown";
+	std::cout << std::endl;
+}
+
+/**
+ * @brief Completes the start of a player name, as far as all the names
+ *	with it agree, and lists the first of the names
+ * @param prefix Start of the name
+ */
+void Scoreboard::complete_name(std::string_view prefix)
+{
+	debug_info();
+	Stat_scope st(STAT_LOOKUP);
+
+	std::vector<Pl_slot> found;
+	std::string common;
+	std::size_t total = players.prefixes().complete(prefix, common,
+													FIND_SHOWN, found);
+	if (!total)
+		report_err("No player name starts with " << prefix, void());
+
+	std::cout << common << std::endl;
+	if (total == 1)
+		return;
+
+	for (Pl_slot pl : found)
+		std::cout << "  " << players.name(pl) << std::endl;
+	if (total > found.size())
+		std::cout << "  ... " << total - found.size() << " more" << std::endl;
+}
+
+/**
+ * @brief Formats a time of the score series as local time
+ * @param time Milliseconds since the epoch
+ * @param buf Output, at least 16 chars
+ * @return Time as HH:MM:SS.mmm
+ */
+static const char *series_time(std::int64_t time, char *buf)
+{
+	std::time_t sec = time / 1000;
+	std::tm tm;
+	localtime_r(&sec, &tm);
+	std::snprintf(buf, 16, "%02d:%02d:%02d.%03d", tm.tm_hour, tm.tm_min,
+					tm.tm_sec, static_cast<int>(time % 1000));
+	return buf;
+}
+
+/**
+ * @brief Prints the past score changes of a player, a line of his trend
+ *	and the last SERIES_SHOWN changes
+ * @param id Id of the player, also of a removed one
+ */
+void Scoreboard::print_series(Pl_id id)
+{
+	debug_info();
+	Stat_scope st(STAT_LOOKUP);
+
+	const Score_series &series = players.timeline();
+	Pl_slot pl = players.find(id);
+	std::string_view name = pl != NO_SLOT ? players.name(pl) :
+								series.gone_name(id.num);
+	if (name.empty())
+		report_err("Player with that id does not exist", void());
+
+	std::vector<Series_point> pts;
+	series.changes(id.num, pts);
+
+	char buf[16];
+	std::cout << name << " (#" << id.num << "): " << pts.size() <<
+		" changes since " << series_time(series.since(), buf);
+	if (pts.empty())
+	{
+		std::cout << std::endl;
+		return;
+	}
+
+	auto [lo, hi] = std::minmax_element(pts.begin(), pts.end(),
+						[](const Series_point &a, const Series_point &b)
+						{
+							return a.score < b.score;
+						});
+	int min = lo->score, max = hi->score;
+	std::cout << ", score " << min << " .. " << max << std::endl;
+
+	// last score of every part of the changes, scaled to 8 levels
+	static const char *const levels[] = {"\u2581", "\u2582", "\u2583",
+		"\u2584", "\u2585", "\u2586", "\u2587", "\u2588"};
+	std::size_t width = std::min<std::size_t>(SPARK_WIDTH, pts.size());
+	for (std::size_t i = 0; i < width; i++)
+	{
+		int score = pts[(i + 1) * pts.size() / width - 1].score;
+		std::cout << levels[max == min ? 3 : 7LL * (score - min) / (max - min)];
+	}
+	std::cout << std::endl;
+
+	for (std::size_t i = pts.size() - std::min<std::size_t>(pts.size(),
+			SERIES_SHOWN); i < pts.size(); i++)
+	{
+		std::cout << "  " << series_time(pts[i].time, buf) << "  ";
+		if (pts[i].kind == SK_JOIN)
+			std::cout << "added with " << pts[i].score << std::endl;
+		else if (pts[i].kind == SK_LEAVE)
+			std::cout << "removed" << std::endl;
+		else
+			std::cout << (pts[i].delta > 0 ? "+" : "") << pts[i].delta <<
+				" -> " << pts[i].score << std::endl;
+	}
+}
+
+/**
+ * @brief Prints the board as it was at a time, rebuilt from the last
+ *	checkpoint of the score series before it, players are shown with their
+ *	current names, removed ones with their last names
+ * @param time Milliseconds since the epoch
+ */
+void Scoreboard::print_at(std::int64_t time)
+{
+	debug_info();
+	Stat_scope st(STAT_RENDER);
+
+	const Score_series &series = players.timeline();
+	std::vector<std::pair<std::uint32_t, int>> state;
+	char buf[16];
+	if (!series.state_at(time, state))
+		report_err("No changes recorded before " <<
+					series_time(series.since(), buf), void());
+
+	/**
+	 * @brief Player at the time
+	 */
+	struct Past
+	{
+		std::string_view name;		///< Empty if the name is forgotten
+		int score;
+		std::uint32_t id;
+	};
+
+	std::vector<Past> past;
+	past.reserve(state.size());
+	for (const auto &[id, score] : state)
+	{
+		Pl_slot pl = players.find(Pl_id{id});
+		past.push_back(Past{pl != NO_SLOT ? players.name(pl) :
+							series.gone_name(id), score, id});
+	}
+	std::sort(past.begin(), past.end(), [](const Past &a, const Past &b)
+				{
+					return Rank_index::higher(a.score, a.name, b.score,
+												b.name);
+				});
+
+	std::size_t limit = show_max == HGHT_LIMIT ? past.size() :
+						std::min<std::size_t>(show_max, past.size());
+	render.set_width(Table_render::term_width());
+	render.begin();
+	for (std::size_t i = 0; i < limit; i++)
+	{
+		char id[16];
+		std::string_view name = past[i].name;
+		if (name.empty())
+			name = std::string_view(id, std::snprintf(id, sizeof(id), "#%u",
+													past[i].id));
+		render.row(i + 1, name, past[i].score);
+	}
+	scb_stats.count(STAT_ROWS, limit);
+
+	std::cout << "Board at " << series_time(time, buf) << ", " <<
+		past.size() << " players" << std::endl;
+	std::cout.write(render.data(), render.size());
+	std::cout.flush();
+}
+
+/**
+ * @brief Gives an immutable view of the ranking, safe to call from other
+ *	threads than the writer, it never waits for the writer, a view is
+ *	published at the end of every mutation out of a batch
+ * @return View of the board, of the last mutation before the call
+ */
+std::shared_ptr<const Board_view> Scoreboard::view()
+{
+	return std::atomic_load(&last_view);
+}
+
+/**
+ * @brief Publishes a view of the board at the end of a mutation, inside a
+ *	batch the view before it stays, the draft is built again after the
+ *	ranking was, else it has the changes of the ranking already
+ */
+void Scoreboard::publish_view()
+{
+	if (batch)
+		return;
+
+	if (view_dirty)
+	{
+		Stat_scope st(STAT_RERANK);
+		draft.clear();
+		ranking.for_each([&](int, Pl_slot pl)
+		{
+			draft.push_back(players.name(pl), players.score(pl),
+							players.id(pl));
+		});
+		view_dirty = false;
+	}
+
+	std::atomic_store(&last_view, draft.publish(
+				version.load(std::memory_order_relaxed) + 1, show_max,
+				max_players, players.next_id()));
+}
+
+/**
+ * @brief Removes a player from all the structures
+ * @param pl Player slot
+ */
+void Scoreboard::erase_player(Pl_slot pl)
+{
+	debug_info();
+	Stat_scope st(STAT_MUTATION);
+	Write_scope ws(*this);
+
+	log_op(Batch_op::REMOVED, players.name(pl), players.score(pl), {},
+			players.id(pl));
+	if (batch && pl < batch_rank.size())
+		batch_rank[pl] = 0;
+
+	journal.append(Journal::J_REMOVE, players.name(pl));
+	unrank(pl);
+	suffixes.release(players.name(pl));
+	players.remove(pl);
+}
+
+/**
+ * @brief Adds a player with an already unique name
+ * @param name Player name
+ * @param score Player score
+ * @return Slot of the new player
+ */
+Pl_slot Scoreboard::insert_player(std::string_view name, int score)
+{
+	debug_info();
+	Stat_scope st(STAT_MUTATION);
+	Write_scope ws(*this);
+
+	Pl_slot pl = players.add(name, score);
+	log_op(Batch_op::ADDED, name);
+	journal.append(Journal::J_ADD, name, score);
+	rerank(pl);
+
+	return pl;
+}
+
+/**
+ * @brief Adds back a removed player with his id, on the replay of an undo
+ *	of his removal
+ * @param name Unique player name
+ * @param score Player score
+ * @param id Id the player had, a new one is given if it is not free
+ * @return Slot of the player
+ */
+Pl_slot Scoreboard::restore_player(std::string_view name, int score,
+									Pl_id id)
+{
+	debug_info();
+	Stat_scope st(STAT_MUTATION);
+	Write_scope ws(*this);
+
+	suffixes.claim(name);
+	Pl_slot pl = players.add(name, score, id);
+	log_op(Batch_op::ADDED, name);
+	journal.append(Journal::J_RESTORE, name, score,
+					std::to_string(players.id(pl).num));
+	rerank(pl);
+
+	return pl;
+}
+
+/**
+ * @brief Changes name of a player to an already unique name
+ * @param pl Player slot
+ * @param new_name New player name
+ */
+void Scoreboard::move_player(Pl_slot pl, std::string_view new_name)
+{
+	debug_info();
+	Stat_scope st(STAT_MUTATION);
+	Write_scope ws(*this);
+
+	unrank(pl);								// name changes the ranking
+	suffixes.release(players.name(pl));
+	journal.append(Journal::J_RENAME, players.name(pl), 0, new_name);
+	log_op(Batch_op::RENAMED, new_name, 0, players.name(pl));
+	players.rename(pl, new_name);			// slot stays the same
+	rerank(pl);
+}
+
+/**
+ * @brief Sets score of a player
+ * @param pl Player slot
+ * @param score New score
+ */
+void Scoreboard::set_score(Pl_slot pl, int score)
+{
+	debug_info();
+	Write_scope ws(*this);
+
+	update_score(pl, score);
+}
+
+/**
+ * @brief Sets score of a player inside an already started mutation
+ * @param pl Player slot
+ * @param score New score
+ */
+void Scoreboard::update_score(Pl_slot pl, int score)
+{
+	debug_info();
+	Stat_scope st(STAT_MUTATION);
+
+	unrank(pl);					// score changes the ranking
+	if (batch || score != players.score(pl))	// same score is no undo step
+		log_op(Batch_op::SCORED, players.name(pl), players.score(pl));
+	journal.append(Journal::J_SCORE, players.name(pl), score);
+	players.set_score(pl, score);
+	rerank(pl);
+}
+
+/**
+ * @brief Starts a batch, mutations are applied at once but the ranking is
+ *	rebuilt only on commit, ranks inside the batch refer to the ranking
+ *	before the batch
+ */
+void Scoreboard::begin_batch()
+{
+	debug_info();
+
+	if (batch)
+		report_err("Batch already started", void());
+
+	start_batch();
+	journal.append(Journal::J_BEGIN);
+	std::cout << "Batch started" << std::endl;
+}
+
+/**
+ * @brief Ends a batch, ranking is rebuilt once if anything changed
+ */
+void Scoreboard::commit_batch()
+{
+	debug_info();
+
+	if (!batch)
+		report_err("No batch started", void());
+
+	std::size_t changes = batch_log.size();
+	end_batch(true);
+	journal.append(Journal::J_COMMIT);
+	std::cout << "Batch committed, " << changes << " changes" << std::endl;
+}
+
+/**
+ * @brief Ends a batch, reverting all its mutations in reverse order
+ */
+void Scoreboard::abort_batch()
+{
+	debug_info();
+
+	if (!batch)
+		report_err("No batch started", void());
+
+	end_batch(false);
+	journal.append(Journal::J_ABORT);
+	std::cout << "Batch aborted" << std::endl;
+}
+
+/**
+ * @brief Captures the current ranking and starts batching
+ */
+void Scoreboard::start_batch()
+{
+	debug_info();
+	Write_scope ws(*this);
+
+	batch_view.clear();
+	batch_view.reserve(ranking.size());
+	batch_rank.assign(players.slots(), 0);
+	ranking.for_each([&](int rank, Pl_slot pl)
+	{
+		batch_view.push_back(pl);
+		batch_rank[pl] = rank;
+	});
+
+	// slots of batch_view are not given to new players until the end
+	players.hold_slots(true);
+	batch = true;
+	rank_dirty = false;
+}
+
+/**
+ * @brief Ends batching, the mutations are either kept or reverted in
+ *	reverse order, ranking is rebuilt once if anything changed
+ * @param commit Keep the mutations
+ */
+void Scoreboard::end_batch(bool commit)
+{
+	debug_info();
+	Write_scope ws(*this);
+
+	for (auto op = batch_log.rbegin(); !commit && op != batch_log.rend(); 
+			op++)
+	{
+		Pl_slot pl = players.find(op->name);
+		switch (op->kind)
+		{
+			case Batch_op::ADDED:
+				suffixes.release(op->name);
+				players.remove(pl);
+				break;
+			case Batch_op::REMOVED:
+				suffixes.claim(op->name);
+				players.add(op->name, op->score, op->id);	// same id
+				break;
+			case Batch_op::RENAMED:
+				suffixes.release(op->name);
+				suffixes.claim(op->old_name);
+				players.rename(pl, op->old_name);
+				break;
+			case Batch_op::SCORED:
+				players.set_score(pl, op->score);
+				break;
+		}
+	}
+
+	players.hold_slots(false);
+	batch = false;
+	if (rank_dirty)
+		sort_scb();
+
+	if (commit && undo_max)		// whole batch is one step of undo
+		for (const Batch_op &op : batch_log)
+			step_op(op.kind, op.name, op.score, op.old_name, op.id);
+
+	batch_view.clear();
+	batch_rank.clear();
+	batch_log.clear();
+}
+
+/**
+ * @brief Reverts the last steps, a step is one mutation of the board, e.g.
+ *	a win, a removal of all the players or a committed batch, players are
+ *	found by their names, so the ranks changed since do not matter
+ * @param n Number of steps
+ */
+void Scoreboard::undo(unsigned n)
+{
+	debug_info();
+
+	if (batch)
+		report_err("Cannot undo inside a batch, commit or abort it first",
+					void());
+	if (!undo_max)
+		report_err("Undo is disabled, use: set undo N", void());
+	if (undo_log.steps.empty())
+		report_err("Nothing to undo", void());
+
+	n = std::min<std::size_t>(n, undo_log.steps.size());
+	std::size_t changes = revert(undo_log, redo_log, n);
+	std::cout << "Undone " << n << " steps, " << changes << " changes" <<
+		std::endl;
+}
+
+/**
+ * @brief Repeats the last undone steps, until a new mutation drops them
+ * @param n Number of steps
+ */
+void Scoreboard::redo(unsigned n)
+{
+	debug_info();
+
+	if (batch)
+		report_err("Cannot redo inside a batch, commit or abort it first",
+					void());
+	if (redo_log.steps.empty())
+		report_err("Nothing to redo", void());
+
+	n = std::min<std::size_t>(n, redo_log.steps.size());
+	std::size_t changes = revert(redo_log, undo_log, n);
+	std::cout << "Redone " << n << " steps, " << changes << " changes" <<
+		std::endl;
+}
+
+/**
+ * @brief Applies the inverse operations of the last steps of one log in
+ *	reverse order, the inverses of what is done are added to the other
+ *	log, each step stays one step, the journal gets the plain mutations
+ * @param from Log of the reverted steps
+ * @param to Log of their inverses
+ * @param n Number of steps, at most the steps of from
+ * @return Number of reverted operations
+ */
+std::size_t Scoreboard::revert(Step_log &from, Step_log &to, unsigned n)
+{
+	debug_info();
+	Stat_scope st(STAT_MUTATION);
+	Write_scope ws(*this);
+
+	std::size_t total = 0;
+	for (unsigned i = 0; i < n; i++)
+		total += from.steps[from.steps.size() - 1 - i];
+
+	// same as apply_scores, many changes are ranked at once
+	bool rebuild = 4 * total > players.size();
+	for (unsigned i = 0; i < n; i++)
+	{
+		std::size_t ops = from.steps.back();
+		from.steps.pop_back();
+		for (std::size_t j = 0; j < ops; j++)
+		{
+			// the slot is not reused before the next push to from
+			Batch_op &op = from.ops.back();
+			from.ops.pop_back();
+			Pl_slot pl = players.find(op.name);
+			if (!rebuild && op.kind != Batch_op::REMOVED)
+				unrank(pl);
+
+			switch (op.kind)
+			{
+				case Batch_op::ADDED:
+					journal.append(Journal::J_REMOVE, op.name);
+					suffixes.release(op.name);
+					to.ops.push_back().set(Batch_op::REMOVED, op.name,
+										players.score(pl), {}, players.id(pl));
+					players.remove(pl);
+					continue;			// not ranked any more
+				case Batch_op::REMOVED:
+					suffixes.claim(op.name);
+					pl = players.add(op.name, op.score, op.id);	// same id
+					journal.append(Journal::J_RESTORE, op.name, op.score,
+									std::to_string(players.id(pl).num));
+					to.ops.push_back().set(Batch_op::ADDED, op.name, 0, {},
+											{0});
+					break;
+				case Batch_op::RENAMED:
+					journal.append(Journal::J_RENAME, op.name, 0, op.old_name);
+					suffixes.release(op.name);
+					suffixes.claim(op.old_name);
+					players.rename(pl, op.old_name);
+					to.ops.push_back().set(Batch_op::RENAMED, op.old_name, 0,
+											op.name, {0});
+					break;
+				case Batch_op::SCORED:
+					journal.append(Journal::J_SCORE, op.name, op.score);
+					to.ops.push_back().set(Batch_op::SCORED, op.name,
+											players.score(pl), {}, {0});
+					players.set_score(pl, op.score);
+					break;
+			}
+
+			if (!rebuild)
+				rerank(pl);
+		}
+		to.steps.push_back() = ops;
+	}
+
+	if (rebuild)
+		sort_scb();
+
+	return total;
+}
+
+/**
+ * @brief Makes a player name unique, if the name is already used, the
+ *	lowest free suffix (N) is appended
+ * @param name Desired name of the player
+ * @param buf Buffer for the name with suffix, PNAME_LIMIT + 16 chars
+ * @return The unique name, valid as long as name and buf are
+ */
+std::string_view Scoreboard::unique_name(std::string_view name, char *buf)
+{
+	debug_info();
+	Stat_scope st(STAT_LOOKUP);
+
+	if (players.find(name) == NO_SLOT)
+		return name;
+
+	std::string_view uniq;
+	do {		// suffix can be used by a player named "name(N)" already
+		uniq = std::string_view(buf, 
+					Suffix_index::format(buf, name, suffixes.take(name)));
+	} while (players.find(uniq) != NO_SLOT);
+
+	return uniq;
+}
+
+/**
+ * @brief Rebuilds the ranking index from scratch, used after changes of
+ *	many players at once, single changes update the index incrementally
+ */
+void Scoreboard::sort_scb()
+{
+	debug_info();
+	Stat_scope st(STAT_RERANK);
+	scb_stats.count(STAT_REBUILDS);
+
+	std::vector<Pl_slot> sorted;
+	sorted.reserve(players.size());
+
+	for (Pl_slot pl = 0; pl < players.slots(); pl++)
+		if (players.used(pl))
+			sorted.push_back(pl);
+
+	// sorting based on the ranking rule, always needed: the slots are not
+	// ordered by name, so equal scores (e.g. after reset) still need it
+	std::sort(sorted.begin(), sorted.end(), 
+				[this](Pl_slot a, Pl_slot b)
+				{
+					return Rank_index::higher(players.score(a), 
+							players.name(a), players.score(b), players.name(b));
+				});
+
+	ranking.build(sorted);
+	view_dirty = true;
 }
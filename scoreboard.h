@@ -14,9 +14,23 @@
 #include <iostream>
 #include <fstream>
 #include <climits>
-#include <map>
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <sys/types.h>
+#include "player_store.h"
+#include "rank_index.h"
+#include "suffix_index.h"
+#include "journal.h"
+#include "render.h"
+#include "stats.h"
+#include "board_view.h"
+#include "ingest.h"
 
 // debugging macros
 #ifndef DEBUG
@@ -39,9 +53,6 @@
 #define report_war(x) do { std::cerr << "<Warning>: " << x << std::endl; \
 	} while(0)
 
-#define LINE_BREAK std::cout << " " << std::string(w.ws_col-2, '-') <<	\
-	std::endl;
-
 /**
  * @brief An enum for all constants used across the program
  */
@@ -62,12 +73,22 @@ enum Consts
 	MAX_PNAME = 32,			// 40 chars, 32 + 7 optional + \0 - max length
 	PNAME_LIMIT = 40,		// hard limit, also true size of string
 
+	// players listed by the search and completion of names
+	FIND_SHOWN = 20,
+
+	// past score changes listed, width of their trend line
+	SERIES_SHOWN = 10,
+	SPARK_WIDTH = 40,
+
+	// steps kept for undo by default, changes kept in all the steps
+	UNDO_DEPTH = 64,
+	UNDO_CHANGES = 1 << 17,
+
 	// terminal constants
 	WIN_PADDING = 32		// window padding
 };
 
-// For convenience use, Player iterator type
-typedef std::map<std::string, int>::iterator Pl_it;
+static_assert(SLOT_NAME == PNAME_LIMIT, "Name slot has to fit any name");
 
 
 /**
@@ -167,57 +188,280 @@ inline void Player::dec_score()
 
 // ----------------------------------------------------------------------
 
+/**
+ * @brief Inverse of a mutation, used to abort a batch and to undo a step
+ */
+struct Batch_op
+{
+	enum Kind { ADDED, REMOVED, RENAMED, SCORED } kind;
+	std::string name;		///< Name of the player after the mutation
+	std::string old_name;	///< RENAMED: name before the mutation
+	int score;				///< REMOVED, SCORED: score before the mutation
+	Pl_id id;				///< REMOVED: id of the player
+
+	/**
+	 * @brief Fills a reused operation, the names keep their buffers
+	 */
+	void set(Kind k, std::string_view nm, int sc, std::string_view old_nm,
+				Pl_id pl_id)
+	{
+		kind = k;
+		name.assign(nm);
+		old_name.assign(old_nm);
+		score = sc;
+		id = pl_id;
+	}
+};
+
+/**
+ * @brief Queue kept in a ring of slots, a dropped item stays in its slot
+ *	until a new one is put there, so a log of steps does not allocate
+ *	once it has grown to its size
+ */
+template<typename T>
+class Log_ring
+{
+		std::vector<T> items;		///< Slots, the queue starts at first
+		std::size_t first;			///< Slot of the oldest item
+		std::size_t count;			///< Items in the queue
+	public:
+		Log_ring(): first{0}, count{0} {}
+
+		std::size_t size() const { return count; }
+		bool empty() const { return !count; }
+		T &operator[](std::size_t i) { return items[(first+i) % items.size()]; }
+		T &front() { return items[first]; }
+		T &back() { return (*this)[count - 1]; }
+		T &push_back();
+		void pop_back() { count--; }
+		void pop_front(std::size_t n = 1)
+		{
+			if (n)
+				first = (first + n) % items.size();
+			count -= n;
+		}
+		void clear() { first = count = 0; }
+};
+
+/**
+ * @brief Takes the slot after the newest item, the ring is doubled when
+ *	it is full
+ * @return Slot with the contents of a dropped item, to be filled
+ */
+template<typename T>
+T &Log_ring<T>::push_back()
+{
+	if (count == items.size())
+	{
+		std::rotate(items.begin(), items.begin() + first, items.end());
+		items.resize(std::max<std::size_t>(16, 2 * items.size()));
+		first = 0;
+	}
+
+	return (*this)[count++];
+}
+
+/**
+ * @brief Steps of undo or redo, each is the inverses of its mutations in
+ *	order, the operations of all the steps are kept in one queue
+ */
+struct Step_log
+{
+	Log_ring<Batch_op> ops;				///< Oldest step first
+	Log_ring<std::size_t> steps;		///< Operations of each step
+
+	void clear() { ops.clear(); steps.clear(); }
+	void drop_oldest()
+	{
+		ops.pop_front(steps.front());
+		steps.pop_front();
+	}
+};
+
 /**
  * @brief Scoreboard class
+ *	Mutations are done by one thread, the writer, readers on other threads
+ *	use only view(), which gives the last published immutable ranking.
  */
 class Scoreboard
 {
-		///< map of player names and player scores
-		std::map<std::string, int> players;	
-		///< used for sorting and printing the output
-		std::vector<std::pair<std::string, int>> pl_sort;	
+		friend class Scb_bench;		///< measures also the private sort_scb
+
+		/**
+		 * @brief Mutation of the board, the board gets a new version and
+		 *	a view of it at its end
+		 */
+		class Write_scope
+		{
+				Scoreboard &scb;
+				std::lock_guard<std::mutex> lock;
+			public:
+				explicit Write_scope(Scoreboard &s): scb{s}, lock{s.write_m} {}
+				Write_scope(const Write_scope &) = delete;
+				Write_scope &operator=(const Write_scope &) = delete;
+				~Write_scope()
+				{
+					scb.end_step();
+					scb.publish_view();		// found by the new version
+					scb.version.fetch_add(1, std::memory_order_release);
+				}
+		};
+
+		///< player names and scores
+		Player_store players;
+		///< ranking of the players, used for rank lookup and printing
+		Rank_index ranking;
+		///< next free "(N)" suffixes of player names
+		Suffix_index suffixes;
+
+		bool batch;					///< Mutations are not ranked until commit
+		bool rank_dirty;			///< Ranking has to be rebuilt on commit
+		///< ranking before the batch, ranks are resolved with it in batch
+		std::vector<Pl_slot> batch_view;
+		///< rank of each slot in batch_view, 0 if not in it or removed
+		///< inside the batch
+		std::vector<int> batch_rank;
+		///< inverse operations of the batch mutations, in order
+		std::vector<Batch_op> batch_log;
+		///< steps to undo, one per mutation, a committed batch is one step
+		Step_log undo_log;
+		///< undone steps to redo, dropped by a new step
+		Step_log redo_log;
+		std::size_t step_ops;		///< Operations of the open step
+		bool step_lost;				///< Open step is over UNDO_CHANGES
+		unsigned undo_max;			///< Most steps kept, 0 disables undo
+		///< journal of the mutations, if opened
+		Journal journal;
+		///< renders the score table to the terminal
+		Table_render render;
+		///< renders the score table to other streams, fixed width
+		Table_render file_render;
 
 		int show_max;				///< How many players are shown
 		unsigned int max_players;	///< Max. players to save info about
-		std::filebuf save_f;		///< Can be printed to a file
 		std::filebuf h_file;		///< History file saved players & scores
+
+		std::mutex write_m;					///< Held by mutations
+		std::atomic<std::uint64_t> version;	///< Changed by every mutation
+		///< ranking for the next view, changed with the ranking index
+		View_draft draft;
+		bool view_dirty;			///< Ranking rebuilt, draft has to be too
+		///< last published view, read and replaced atomically
+		std::shared_ptr<const Board_view> last_view;
+		///< score changes summed per slot by apply_scores, all 0 between
+		std::vector<int> sums;
+		///< slots with a change in sums, a slot can be listed twice
+		std::vector<Pl_slot> touched;
 	public:
 		// default constructor
-		Scoreboard(): show_max{HGHT_LIMIT}, max_players{S_PLIMIT} {}
+		Scoreboard(): ranking{players}, batch{false}, rank_dirty{false},
+						step_ops{0}, step_lost{false}, undo_max{UNDO_DEPTH},
+						show_max{HGHT_LIMIT}, max_players{S_PLIMIT},
+						version{0}, view_dirty{false}
+		{
+			last_view = draft.publish(0, show_max, max_players,
+										players.next_id());
+		}
 		
 		void init_players(int num);
 		void set_show_max(int num);
 		void set_max_players(int num);
+		void set_undo_depth(int num);
 
 		// player modification methods
-		void add_player(const std::string &name = "Player", int score = 0);
+		void add_player(std::string_view name = "Player", int score = 0);
 
 		void rm_player(int rank);
-		void rm_player(const std::string &name);
+		void rm_player(std::string_view name);
+		void rm_player(Pl_id id);
 		void rm_players();
 
-		void rename_player(int rank, const std::string &new_name);
-		void rename_player(const std::string &name, 
-							const std::string &new_name);
+		void rename_player(int rank, std::string_view new_name);
+		void rename_player(std::string_view name, std::string_view new_name);
+		void rename_player(Pl_id id, std::string_view new_name);
 
 		// score modification methods
 		void add_pscore(int rank, int num = 1);
-		void add_pscore(const std::string &name, int num = 1);
+		void add_pscore(std::string_view name, int num = 1);
+		void add_pscore(Pl_id id, int num = 1);
 		void reset_pscore(int rank);
-		void reset_pscore(const std::string &name);
+		void reset_pscore(std::string_view name);
+		void reset_pscore(Pl_id id);
 		void reset_score();
+		std::size_t apply_scores(const Score_event *evs, std::size_t n);
+
+		// batch of mutations, ranked once on commit
+		void begin_batch();
+		void commit_batch();
+		void abort_batch();
+		bool in_batch() const { return batch; }
+
+		// steps of mutations, reverted by their inverse operations
+		void undo(unsigned n = 1);
+		void redo(unsigned n = 1);
 		
-		bool save_to_file(std::ostream file);
-		bool load_players_from_file(std::istream file);
-		bool load_history(std::istream file);
+		bool save_to_file(const std::string &path);
+		pid_t save_forked(const std::string &path);
+		bool load_from_file(const std::string &path);
+		bool load_players_from_file(const std::string &path);
+		bool load_history(const std::string &path);
 
-		void print(std::ostream & strm = std::cout);
+		// journal of mutations, folded into a snapshot on compaction
+		bool open_journal(const std::string &path, unsigned every,
+							unsigned ms);
+		bool compact();
 
-		~Scoreboard() {	rm_players(); }	///< destructor
+		void print(std::ostream & strm = std::cout);
+		void find_players(std::string_view pattern);
+		void complete_name(std::string_view prefix);
+		void print_series(Pl_id id);
+		void print_at(std::int64_t time);
+
+		// readers on other threads
+		std::shared_ptr<const Board_view> view();
+
+		int get_rank(std::string_view name);
+		Pl_id get_id(int rank);
+		Pl_id get_id(std::string_view name);
+		std::size_t player_count() const { return players.size(); }
+		///< changed by every mutation, readable by any thread
+		std::uint64_t get_version() const
+		{
+			return version.load(std::memory_order_acquire);
+		}
+
+		~Scoreboard() { journal.close(); rm_players(); }	///< destructor
 	private:
-		void sort_scb();				///< sorting function for vector
-		Pl_it get_player(int rank);
-		Pl_it get_player(const std::string &name);
+		void sort_scb();				///< rebuilds the ranking index
+		Pl_slot get_player(int rank);
+		int rank_of(Pl_slot pl);
+		Pl_slot get_player(std::string_view name);
+		Pl_slot get_player(Pl_id id);
+		std::string_view unique_name(std::string_view name, char *buf);
+
+		void unrank(Pl_slot pl);
+		void rerank(Pl_slot pl);
+		void erase_player(Pl_slot pl);
+		Pl_slot insert_player(std::string_view name, int score);
+		Pl_slot restore_player(std::string_view name, int score, Pl_id id);
+		void move_player(Pl_slot pl, std::string_view new_name);
+		void set_score(Pl_slot pl, int score);
+		void update_score(Pl_slot pl, int score);
+		void start_batch();
+		void end_batch(bool commit);
+		void end_step();
+		void forget_steps();
+		void publish_view();
+		std::size_t revert(Step_log &from, Step_log &to, unsigned n);
+
+		bool write_snapshot(const std::string &path, std::uint32_t gen);
+		bool read_snapshot(const std::string &path, std::uint32_t &gen);
+		void replay(const Journal::Record &rec);
+		void log_op(Batch_op::Kind kind, std::string_view name,
+					int score = 0, std::string_view old_name = {},
+					Pl_id id = {0});
+		void step_op(Batch_op::Kind kind, std::string_view name, int score,
+					std::string_view old_name, Pl_id id);
 };
 
 /**
@@ -231,44 +475,126 @@ inline void Scoreboard::set_show_max(int num)
 	if (num < 0 || num > USHRT_MAX)
 		report_err("Incorrect number of maximum players shown", void());
 
-	show_max = num;
+	{
+		Write_scope ws(*this);
+		show_max = num;
+	}
+	journal.append(Journal::J_SHOW, {}, num);
 	std::cout << "Player show limit set to: " << show_max << std::endl;
 }
 
 /**
- * @brief Gets a pointer reference to a player using his rank
+ * @brief Gets a player using his rank
  * @param rank A position in the table score system
- * @return Pointer to the player iterator
+ * @return Slot of the player, NO_SLOT if there is no such player
  */ 
-inline Pl_it Scoreboard::get_player(int rank)
+inline Pl_slot Scoreboard::get_player(int rank)
 {
 	debug_info();
+	Stat_scope st(STAT_LOOKUP);
+
+	if (batch)		// ranks in batch refer to the ranking before it
+	{
+		if (rank < 1 || static_cast<unsigned int>(rank) > batch_view.size())
+			report_err("Incorrect player rank", NO_SLOT);
+
+		Pl_slot pl = batch_view[rank-1];
+		if (!batch_rank[pl])
+			report_err("Player with that rank was removed in this batch",
+						NO_SLOT);
+
+		return pl;
+	}
 
 	// use exceptions TODO
-	if ( (rank < 1) || (static_cast<unsigned int>(rank) > players.size()))	
-		report_err("Incorrect player rank", players.end());
+	Pl_slot pl = ranking.select(rank);
+	if (pl == NO_SLOT)
+		report_err("Incorrect player rank", NO_SLOT);
 	
-	std::vector<std::pair<std::string, int>>::iterator it = 
-		std::next(pl_sort.begin(), rank-1);
-	
-	return players.find(it->first);
+	return pl;
 }
 
 /**
- * @brief Gets a pointer reference to a player using his name
+ * @brief Gets a player using his name
  * @param name Player's identifiable name
- * @param Pointer to the player iterator
+ * @return Slot of the player, NO_SLOT if there is no such player
  */
-inline Pl_it Scoreboard::get_player(const std::string &name)
+inline Pl_slot Scoreboard::get_player(std::string_view name)
 {
 	debug_info();
+	Stat_scope st(STAT_LOOKUP);
 
 	if (name.empty() || name.length() > PNAME_LIMIT)
-		return players.end();
+		return NO_SLOT;
 
 	return players.find(name);
 }
 
+/**
+ * @brief Gets a player using his id, a single access to the id array
+ * @param id Player's id, given on his creation
+ * @return Slot of the player, NO_SLOT if there is no such player
+ */
+inline Pl_slot Scoreboard::get_player(Pl_id id)
+{
+	debug_info();
+	Stat_scope st(STAT_LOOKUP);
+
+	return players.find(id);
+}
+
+/**
+ * @brief Gets rank of a player using his name
+ * @param name Player's identifiable name
+ * @return Rank of the player, 0 if there is no such player
+ */
+inline int Scoreboard::get_rank(std::string_view name)
+{
+	debug_info();
+
+	Pl_slot pl = get_player(name);
+	return pl == NO_SLOT ? 0 : rank_of(pl);
+}
+
+/**
+ * @brief Gets rank of a player using his slot
+ * @param pl Slot of the player
+ * @return Rank of the player, 0 if he was added in the batch
+ */
+inline int Scoreboard::rank_of(Pl_slot pl)
+{
+	if (batch)		// rank before the batch
+		return pl < batch_rank.size() ? batch_rank[pl] : 0;
+
+	return ranking.rank(pl);
+}
+
+/**
+ * @brief Gets id of a player using his rank
+ * @param rank A position in the table score system
+ * @return Id of the player, 0 if there is no such player
+ */
+inline Pl_id Scoreboard::get_id(int rank)
+{
+	debug_info();
+
+	Pl_slot pl = get_player(rank);
+	return pl == NO_SLOT ? Pl_id{0} : players.id(pl);
+}
+
+/**
+ * @brief Gets id of a player using his name
+ * @param name Player's identifiable name
+ * @return Id of the player, 0 if there is no such player
+ */
+inline Pl_id Scoreboard::get_id(std::string_view name)
+{
+	debug_info();
+
+	Pl_slot pl = get_player(name);
+	return pl == NO_SLOT ? Pl_id{0} : players.id(pl);
+}
+
 /**
  * @brief Empties both structures
  */
@@ -276,8 +602,25 @@ inline void Scoreboard::rm_players()
 {
 	debug_info();
 
+	if (batch)		// each removal has to be revertible
+	{
+		for (Pl_slot pl = 0; pl < players.slots(); pl++)
+			if (players.used(pl))
+				erase_player(pl);
+		return;
+	}
+
+	Write_scope ws(*this);
+	journal.append(Journal::J_REMOVE_ALL);
+	view_dirty = true;
+	if (undo_max)	// one step, which adds all the players back
+		for (Pl_slot pl = 0; pl < players.slots(); pl++)
+			if (players.used(pl))
+				log_op(Batch_op::REMOVED, players.name(pl), players.score(pl),
+						{}, players.id(pl));
+	ranking.clear();
+	suffixes.clear();
 	players.clear();
-	pl_sort.clear();
 }
 
 /**
@@ -286,11 +629,134 @@ inline void Scoreboard::rm_players()
 inline void Scoreboard::reset_score()
 {
 	debug_info();
+	Write_scope ws(*this);
+
+	// scores are scanned linearly, free slots are reset too
+	for (Pl_slot pl = 0; pl < players.slots(); pl++)
+	{
+		if (players.used(pl) && players.score(pl))	// logged if needed
+			log_op(Batch_op::SCORED, players.name(pl), players.score(pl));
+		players.set_score(pl, 0);
+	}
+
+	journal.append(Journal::J_RESET_ALL);
+	if (batch)
+		rank_dirty = true;
+	else
+		sort_scb();				// need to sort again
+}
+
+/**
+ * @brief Removes a player from the ranking and from the draft of the view
+ *	before his score or name is changed, inside a batch only marks the
+ *	ranking dirty
+ * @param pl Player slot
+ */
+inline void Scoreboard::unrank(Pl_slot pl)
+{
+	if (batch)
+		rank_dirty = true;
+	else
+	{
+		Stat_scope st(STAT_RERANK);
+		int rank = ranking.erase(pl);
+		if (rank && !view_dirty)
+			draft.erase(rank - 1);
+	}
+}
+
+/**
+ * @brief Ranks a player again after his score or name was changed, the
+ *	draft of the view gets his row at his rank
+ * @param pl Player slot
+ */
+inline void Scoreboard::rerank(Pl_slot pl)
+{
+	if (batch)
+		rank_dirty = true;
+	else
+	{
+		Stat_scope st(STAT_RERANK);
+		int rank = ranking.insert(pl);
+		if (!view_dirty)
+			draft.insert(rank - 1, players.name(pl), players.score(pl),
+						players.id(pl));
+	}
+}
+
+/**
+ * @brief Records the inverse of a mutation, for the abort of a batch or
+ *	in the open step of undo
+ * @param kind Type of the mutation
+ * @param name Player name after the mutation
+ * @param score Score before the mutation
+ * @param old_name Player name before the mutation
+ * @param id Id of the removed player
+ */
+inline void Scoreboard::log_op(Batch_op::Kind kind, std::string_view name,
+								int score, std::string_view old_name,
+								Pl_id id)
+{
+	if (batch)
+		batch_log.push_back(Batch_op{kind, std::string(name),
+									std::string(old_name), score, id});
+	else if (undo_max)
+		step_op(kind, name, score, old_name, id);
+}
+
+/**
+ * @brief Adds an operation to the open step of undo, the oldest steps are
+ *	dropped to keep at most UNDO_CHANGES operations, a step with more is
+ *	not kept at all
+ * @param kind, name, score, old_name, id Inverse of the mutation
+ */
+inline void Scoreboard::step_op(Batch_op::Kind kind, std::string_view name,
+								int score, std::string_view old_name,
+								Pl_id id)
+{
+	while (undo_log.ops.size() >= UNDO_CHANGES && !undo_log.steps.empty())
+		undo_log.drop_oldest();
 
-	for (auto it = players.begin(); it != players.end(); it++)
-		it->second = 0;
+	if (undo_log.ops.size() >= UNDO_CHANGES)
+		step_lost = true;
+	else
+	{
+		undo_log.ops.push_back().set(kind, name, score, old_name, id);
+		step_ops++;
+	}
+}
 
-	sort_scb();					// need to sort again
+/**
+ * @brief Closes the open step of undo at the end of a mutation, a new
+ *	step drops the undone ones, the oldest steps over the depth are dropped
+ */
+inline void Scoreboard::end_step()
+{
+	if (!step_ops)
+		return;
+
+	undo_log.steps.push_back() = step_ops;
+	step_ops = 0;
+	redo_log.clear();
+	while (undo_log.steps.size() > undo_max)
+		undo_log.drop_oldest();
+
+	if (step_lost)		// only the open step was left, it cannot be undone
+	{
+		undo_log.clear();
+		step_lost = false;
+	}
+}
+
+/**
+ * @brief Drops all the steps, after a change which cannot be undone
+ */
+inline void Scoreboard::forget_steps()
+{
+	step_ops = 0;
+	step_lost = false;
+	undo_log.clear();
+	redo_log.clear();
 }
 		
 #endif	// include SCOREBOARD_H
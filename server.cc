@@ -0,0 +1,439 @@
+/**
+ * @file server.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the Unix domain socket server
+ */
+
+#include "server.h"
+#include "interface.h"
+#include "scoreboard.h"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <streambuf>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+///< Write end of the pipe signalling SIGINT and SIGTERM to the event loop
+static int sig_wr = -1;
+
+/**
+ * @brief SIGINT and SIGTERM handler, wakes up the event loop
+ */
+static void on_stop(int)
+{
+	int err = errno;
+	char c = 0;
+	if (write(sig_wr, &c, 1) < 0)
+		{}			// pipe is full, the loop is woken up already
+	errno = err;
+}
+
+/**
+ * @brief Stream buffer appending the output of a command to the replies
+ *	of a client, for the errors it also marks the reply as failed, lines
+ *	of warnings do not mark it
+ */
+class Reply_buf : public std::streambuf
+{
+		std::string *out = nullptr;	///< Replies of the client
+		bool *err = nullptr;		///< Reply failed, only for the errors
+		bool line_start = true;		///< Next chunk starts a line
+		bool warning = false;		///< Current line is a warning
+
+		void mark(const char *s, std::streamsize n)
+		{
+			if (!err || !n)
+				return;
+
+			if (line_start)
+				warning = !std::strncmp(s, "<Warning>", std::min<
+										std::streamsize>(n, 9)) && n >= 9;
+			if (!warning)
+				*err = true;
+			line_start = s[n-1] == '\n';
+		}
+	public:
+		void target(std::string *o, bool *e = nullptr)
+		{
+			out = o;
+			err = e;
+			line_start = true;
+			warning = false;
+		}
+	protected:
+		int_type overflow(int_type c) override
+		{
+			if (!traits_type::eq_int_type(c, traits_type::eof()))
+			{
+				char ch = traits_type::to_char_type(c);
+				out->push_back(ch);
+				mark(&ch, 1);
+			}
+			return traits_type::not_eof(c);
+		}
+		std::streamsize xsputn(const char *s, std::streamsize n) override
+		{
+			out->append(s, n);
+			mark(s, n);
+			return n;
+		}
+};
+
+/**
+ * @brief Creates the listening socket, a stale socket file left by a
+ *	crashed server is replaced, a socket of a running one is not
+ * @param sock_path Path of the socket
+ * @return True on success
+ */
+bool Scb_server::open(const std::string &sock_path)
+{
+	debug_info();
+
+	sockaddr_un addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (sock_path.empty() || sock_path.size() >= sizeof(addr.sun_path))
+		report_err("Socket path " << sock_path << " is too long", false);
+	std::memcpy(addr.sun_path, sock_path.data(), sock_path.size());
+
+	lfd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (lfd < 0)
+		report_err("Cannot create socket: " << std::strerror(errno), false);
+
+	struct stat st;
+	if (!::stat(sock_path.c_str(), &st))
+	{
+		int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		bool alive = probe >= 0 && S_ISSOCK(st.st_mode) && !::connect(probe,
+						reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+		if (probe >= 0)
+			::close(probe);
+
+		if (alive || !S_ISSOCK(st.st_mode))
+		{
+			close();
+			report_err("Socket path " << sock_path << " is in use", false);
+		}
+		::unlink(sock_path.c_str());
+	}
+
+	if (::bind(lfd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) ||
+		::listen(lfd, SRV_BACKLOG))
+	{
+		int err = errno;
+		close();
+		report_err("Cannot listen on " << sock_path << ": " <<
+					std::strerror(err), false);
+	}
+	path = sock_path;
+
+	int pfd[2];
+	efd = ::epoll_create1(EPOLL_CLOEXEC);
+	if (efd < 0 || ::pipe2(pfd, O_NONBLOCK | O_CLOEXEC))
+	{
+		int err = errno;
+		close();
+		report_err("Cannot create event loop: " << std::strerror(err), false);
+	}
+	sfd = pfd[0];
+	sig_wr = pfd[1];
+
+	epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.fd = lfd;
+	::epoll_ctl(efd, EPOLL_CTL_ADD, lfd, &ev);
+	ev.data.fd = sfd;
+	::epoll_ctl(efd, EPOLL_CTL_ADD, sfd, &ev);
+
+	struct sigaction sa;
+	std::memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = on_stop;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGINT, &sa, nullptr);
+	sigaction(SIGTERM, &sa, nullptr);
+
+	// replies go to the clients, table width does not follow the terminal
+	Table_render::use_terminal(false);
+
+	std::cout << "Listening on " << path << std::endl;
+	return true;
+}
+
+/**
+ * @brief Event loop, serves the clients until SIGINT or SIGTERM
+ * @return Exit status of the program
+ */
+int Scb_server::run()
+{
+	debug_info();
+
+	epoll_event evs[SRV_EVENTS];
+	for (;;)
+	{
+		int n = ::epoll_wait(efd, evs, SRV_EVENTS, -1);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0)
+			report_err("Event loop failed: " << std::strerror(errno),
+						EXIT_FAILURE);
+
+		for (int i = 0; i < n; i++)
+		{
+			int fd = evs[i].data.fd;
+			if (fd == sfd)
+			{
+				std::cout << "Server stopped, " << conns.size() <<
+					" clients disconnected" << std::endl;
+				close();
+				return EXIT_SUCCESS;
+			}
+
+			if (fd == lfd)
+			{
+				accept_all();
+				continue;
+			}
+
+			auto it = conns.find(fd);
+			if (it == conns.end())		// dropped by an earlier event
+				continue;
+
+			if (evs[i].events & EPOLLOUT)
+				on_write(*it->second);
+			else if (evs[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+				on_read(*it->second);
+		}
+	}
+}
+
+/**
+ * @brief Closes all the connections and the socket, removes its file
+ */
+void Scb_server::close()
+{
+	for (auto &c : conns)
+		::close(c.first);
+	conns.clear();
+
+	if (lfd >= 0)
+		::close(lfd);
+	if (!path.empty())
+		::unlink(path.c_str());
+	if (efd >= 0)
+		::close(efd);
+	if (sfd >= 0)
+	{
+		::close(sfd);
+		::close(sig_wr);
+		sig_wr = -1;
+	}
+
+	lfd = efd = sfd = -1;
+	path.clear();
+}
+
+/**
+ * @brief Accepts all the pending connections
+ */
+void Scb_server::accept_all()
+{
+	for (;;)
+	{
+		int fd = ::accept4(lfd, nullptr, nullptr,
+							SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0)
+		{
+			if (errno == EMFILE || errno == ENFILE)
+				report_war("Too many clients: " << std::strerror(errno));
+			return;			// EAGAIN, or accepted on the next event
+		}
+
+		auto c = std::make_unique<Conn>();
+		c->fd = fd;
+
+		epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.fd = fd;
+		if (::epoll_ctl(efd, EPOLL_CTL_ADD, fd, &ev))
+		{
+			::close(fd);
+			continue;
+		}
+		conns.emplace(fd, std::move(c));
+	}
+}
+
+/**
+ * @brief Reads requests of a client, one read per event, so a busy client
+ *	does not starve the others, executes the complete lines and replies
+ * @param c Connection of the client
+ */
+void Scb_server::on_read(Conn &c)
+{
+	char buf[1u << 16];
+	ssize_t n = ::read(c.fd, buf, sizeof(buf));
+
+	if (n < 0 && (errno == EAGAIN || errno == EINTR))
+		return;
+	if (n < 0)
+		return drop(c);
+
+	if (n == 0)				// replies to the last requests are still sent
+	{
+		if (!c.in.empty() && c.in.back() != '\n')
+			c.in += '\n';		// last request without a newline
+		c.closing = true;
+	}
+	else
+		c.in.append(buf, n);
+
+	serve(c);
+}
+
+/**
+ * @brief Sends the rest of the replies, then executes the requests held
+ *	back while the client was not reading its replies
+ * @param c Connection of the client
+ */
+void Scb_server::on_write(Conn &c)
+{
+	if (!flush(c) || c.writing)
+		return;
+
+	serve(c);
+}
+
+/**
+ * @brief Executes the requests and sends the replies, until all the
+ *	complete requests are executed or the client stops reading
+ * @param c Connection of the client
+ */
+void Scb_server::serve(Conn &c)
+{
+	do {
+		execute(c);
+		if (!flush(c))
+			return;
+	} while (!c.writing && c.in.find('\n') != std::string::npos);
+}
+
+/**
+ * @brief Executes the complete request lines, output of the commands is
+ *	collected into the replies, stops when the unsent replies are too long
+ * @param c Connection of the client
+ */
+void Scb_server::execute(Conn &c)
+{
+	static Reply_buf out_buf, err_buf;
+
+	std::streambuf *cout_b = std::cout.rdbuf(&out_buf);
+	std::streambuf *cerr_b = std::cerr.rdbuf(&err_buf);
+
+	std::size_t start = 0, nl;
+	while (!c.writing && (nl = c.in.find('\n', start)) != std::string::npos)
+	{
+		std::string_view line(c.in.data() + start, nl - start);
+		if (!line.empty() && line.back() == '\r')
+			line.remove_suffix(1);
+		start = nl + 1;
+
+		bool err = false;
+		out_buf.target(&c.out);
+		err_buf.target(&c.out, &err);
+		if (exec_cmd(line) == UC_EXIT)
+		{
+			c.out += "OK\n";
+			c.closing = true;
+			start = c.in.size();	// requests after exit are not executed
+			break;
+		}
+		c.out += err ? "ERR\n" : "OK\n";
+
+		if (c.out.size() - c.sent > SRV_OUT_MAX)
+			break;				// rest waits until the client reads
+	}
+
+	std::cout.rdbuf(cout_b);
+	std::cerr.rdbuf(cerr_b);
+
+	c.in.erase(0, start);
+	if (c.in.size() > SRV_LINE_MAX && c.in.find('\n') == std::string::npos)
+	{
+		c.out += "<Error>: Request line too long\nERR\n";
+		c.in.clear();
+		c.closing = true;
+	}
+}
+
+/**
+ * @brief Sends the replies as far as the socket takes them
+ * @param c Connection of the client
+ * @return False if the connection was dropped
+ */
+bool Scb_server::flush(Conn &c)
+{
+	while (c.sent < c.out.size())
+	{
+		ssize_t n = ::send(c.fd, c.out.data() + c.sent, c.out.size() - c.sent,
+							MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0 && errno == EAGAIN)
+		{
+			if (!c.writing)
+				watch(c, true);
+			return true;
+		}
+		if (n < 0)
+		{
+			drop(c);
+			return false;
+		}
+		c.sent += n;
+	}
+
+	c.out.clear();			// keeps its capacity for the next replies
+	c.sent = 0;
+	if (c.closing && c.in.find('\n') == std::string::npos)
+	{
+		drop(c);
+		return false;
+	}
+	if (c.writing)
+		watch(c, false);
+
+	return true;
+}
+
+/**
+ * @brief Switches between waiting for requests and for a writable socket,
+ *	requests are not read while replies wait
+ * @param c Connection of the client
+ * @param out Wait for the socket to be writable
+ */
+void Scb_server::watch(Conn &c, bool out)
+{
+	epoll_event ev;
+	ev.events = out ? EPOLLOUT : EPOLLIN;
+	ev.data.fd = c.fd;
+	::epoll_ctl(efd, EPOLL_CTL_MOD, c.fd, &ev);
+	c.writing = out;
+}
+
+/**
+ * @brief Closes a connection, the reference is not valid afterwards
+ * @param c Connection of the client
+ */
+void Scb_server::drop(Conn &c)
+{
+	int fd = c.fd;
+	::epoll_ctl(efd, EPOLL_CTL_DEL, fd, nullptr);
+	::close(fd);
+	conns.erase(fd);
+}
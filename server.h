@@ -0,0 +1,70 @@
+/**
+ * @file server.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Server mode, the command grammar served over a Unix domain socket
+ *	One thread serves all the clients with epoll. A request is a command
+ *	line, its reply is the output and the errors of the command followed
+ *	by a line "OK", or "ERR" if the command reported an error. Requests
+ *	can be pipelined, replies to all the lines read at once are written
+ *	at once. "exit" closes the connection of the client only, the server
+ *	ends on SIGINT or SIGTERM.
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+const std::size_t SRV_LINE_MAX = 4096;		///< Longest request line
+const std::size_t SRV_OUT_MAX = 1u << 20;	///< Unsent replies of a client
+const int SRV_BACKLOG = 512;				///< Pending connections
+const int SRV_EVENTS = 64;					///< Events taken at once
+
+/**
+ * @brief Unix domain socket server executing the commands by exec_cmd
+ */
+class Scb_server
+{
+		/**
+		 * @brief Connection of a client
+		 */
+		struct Conn
+		{
+			int fd;					///< Socket of the client
+			std::string in;			///< Received, not executed yet
+			std::string out;		///< Replies, not sent yet
+			std::size_t sent = 0;	///< Sent part of out
+			bool writing = false;	///< Waits for the socket to be writable
+			bool closing = false;	///< Closed after the replies are sent
+		};
+
+		std::string path;			///< Path of the socket
+		int lfd;					///< Listening socket
+		int efd;					///< Epoll instance
+		int sfd;					///< Signal fd, SIGINT and SIGTERM
+		std::unordered_map<int, std::unique_ptr<Conn>> conns;
+	public:
+		Scb_server(): lfd{-1}, efd{-1}, sfd{-1} {}
+		Scb_server(const Scb_server &) = delete;
+		Scb_server &operator=(const Scb_server &) = delete;
+
+		bool open(const std::string &sock_path);
+		int run();
+		void close();
+
+		~Scb_server() { close(); }
+	private:
+		void accept_all();
+		void on_read(Conn &c);
+		void on_write(Conn &c);
+		void serve(Conn &c);
+		void execute(Conn &c);
+		bool flush(Conn &c);
+		void watch(Conn &c, bool out);
+		void drop(Conn &c);
+};
+
+#endif	// include SERVER_H
@@ -0,0 +1,167 @@
+/**
+ * @file snap_fork.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the snapshots written by child processes
+ */
+
+#include "snap_fork.h"
+#include "scoreboard.h"
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+
+/**
+ * @brief Starts a snapshot written by a child process
+ * @param file Path of the snapshot file
+ * @return True if the child was started
+ */
+bool Snap_fork::start(const std::string &file)
+{
+	debug_info();
+
+	if (running())
+		report_err("Snapshot " << path << " is still being written", false);
+	if (!spawn(file))
+	{
+		report();
+		return false;
+	}
+
+	std::cout << "Snapshot of " << players << " players started, fork took " <<
+		std::chrono::duration_cast<std::chrono::microseconds>(paused).count()
+		<< " us" << std::endl;
+	return true;
+}
+
+/**
+ * @brief Sets periodic snapshots, the first one is written after the
+ *	period even if the board did not change
+ * @param file Path of the snapshot file
+ * @param seconds Period, 0 stops the snapshots
+ */
+void Snap_fork::set_every(const std::string &file, unsigned seconds)
+{
+	debug_info();
+
+	every_path = file;
+	every = std::chrono::seconds(seconds);
+	saved = ~static_cast<std::uint64_t>(0);
+	started = clock::now();
+}
+
+/**
+ * @brief Reaps the finished child and starts a periodic snapshot if it is
+ *	due, called between the commands and by the ingest applier, always
+ *	with the board held, so it does not change, nothing is printed here,
+ *	see report
+ */
+void Snap_fork::poll()
+{
+	int status;
+	if (running() && ::waitpid(child, &status, WNOHANG) == child)
+		reap(status);
+
+	if (every.count() && !running() && !scb.in_batch() &&
+		scb.get_version() != saved && clock::now() - started >= every)
+		spawn(every_path);
+}
+
+/**
+ * @brief Prints the results of the reaped children and the failures of
+ *	the periodic snapshots, called by the thread of the commands with the
+ *	board held
+ */
+void Snap_fork::report()
+{
+	if (!errors.empty())
+	{
+		std::cerr << errors << std::flush;
+		errors.clear();
+	}
+	if (!notes.empty())
+	{
+		std::cout << notes << std::flush;
+		notes.clear();
+	}
+}
+
+/**
+ * @brief Waits for the running child, reaps it and reports it
+ */
+void Snap_fork::wait()
+{
+	int status;
+	while (running())
+	{
+		if (::waitpid(child, &status, 0) == child)
+			reap(status);
+		else if (errno != EINTR)
+			child = -1;
+	}
+
+	report();
+}
+
+/**
+ * @brief Forks the child writing the snapshot
+ * @param file Path of the snapshot file
+ * @return True if the child was started
+ */
+bool Snap_fork::spawn(const std::string &file)
+{
+	// a failed periodic snapshot is tried again after the period
+	started = clock::now();
+	forked = std::chrono::system_clock::now();
+	std::uint64_t version = scb.get_version();
+
+	pid_t pid = scb.save_forked(file);
+	if (pid < 0)
+	{
+		errors += std::string("<Error>: Cannot fork: ") +
+					std::strerror(errno) + "\n";
+		return false;
+	}
+
+	paused = clock::now() - started;
+	child = pid;
+	path = file;
+	players = scb.player_count();
+	saved = version;
+	return true;
+}
+
+/**
+ * @brief Keeps the result of the child for report
+ * @param status Status of the child from waitpid
+ */
+void Snap_fork::reap(int status)
+{
+	child = -1;
+
+	struct stat st;
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS ||
+		::stat(path.c_str(), &st))
+	{
+		errors += "<Error>: Snapshot " + path + " failed\n";
+		return;
+	}
+
+	auto written = std::chrono::system_clock::time_point(
+						std::chrono::duration_cast<
+							std::chrono::system_clock::duration>(
+								std::chrono::seconds(st.st_mtim.tv_sec) +
+								std::chrono::nanoseconds(st.st_mtim.tv_nsec)));
+	auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+					std::max(written - forked,
+							std::chrono::system_clock::duration::zero()));
+
+	scb_stats.count(STAT_SNAPSHOTS);
+	std::ostringstream note;
+	note << "Snapshot " << path << " written, " << players << " players, " <<
+		st.st_size << " bytes in " << ms.count() << " ms\n";
+	notes += note.str();
+}
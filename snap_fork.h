@@ -0,0 +1,69 @@
+/**
+ * @file snap_fork.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Snapshots of the board written by a child process. The child made
+ *	by fork() shares the memory of the board copy-on-write, so it sees the
+ *	board as it was at the fork while the parent goes on with the commands,
+ *	pages are copied only when the parent changes them. The child writes
+ *	the same file as "save" (see snapshot.h) and ends, the parent reaps it
+ *	between the commands, or in the tick of the ingest applier, and keeps
+ *	the file size and how long the child wrote it, until the last write to
+ *	the file, by its modification time. The thread of the commands reports
+ *	them, the output of the applier could go to a client of the server.
+ *	One child runs at a time, periodic snapshots are started the same way
+ *	after the period, only if the board changed.
+ */
+
+#ifndef SNAP_FORK_H
+#define SNAP_FORK_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+
+class Scoreboard;
+
+/**
+ * @brief Child process writing a snapshot, and the period of snapshots
+ */
+class Snap_fork
+{
+		using clock = std::chrono::steady_clock;
+
+		Scoreboard &scb;
+		pid_t child;					///< Writing child, -1 if none
+		std::string path;				///< Snapshot file of the child
+		std::size_t players;			///< Players in its snapshot
+		clock::time_point started;		///< Time of the last fork
+		clock::duration paused;			///< Time the fork took
+		std::chrono::system_clock::time_point forked;	///< Same, wall clock
+
+		std::string every_path;			///< File of periodic snapshots
+		std::chrono::seconds every;		///< Period, 0 if none
+		std::uint64_t saved;			///< Board version of the last one
+
+		std::string notes;				///< Results not reported yet
+		std::string errors;				///< Failures not reported yet
+	public:
+		explicit Snap_fork(Scoreboard &board): scb{board}, child{-1},
+												players{0}, every{0},
+												saved{0} {}
+		Snap_fork(const Snap_fork &) = delete;
+		Snap_fork &operator=(const Snap_fork &) = delete;
+
+		bool start(const std::string &file);
+		void set_every(const std::string &file, unsigned seconds);
+		void poll();
+		void report();
+		void wait();
+		bool running() const { return child > 0; }
+
+		~Snap_fork() { wait(); }
+	private:
+		bool spawn(const std::string &file);
+		void reap(int status);
+};
+
+#endif	// include SNAP_FORK_H
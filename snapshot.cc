@@ -0,0 +1,231 @@
+/**
+ * @file snapshot.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the binary snapshot writer and reader
+ */
+
+#include "snapshot.h"
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>		// open
+#include <sys/mman.h>	// mmap
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+/**
+ * @brief Fletcher like checksum over 32-bit words of the records
+ * @param data Records
+ * @param size Size of the records in bytes
+ * @return Checksum
+ */
+std::uint64_t snap_checksum(const void *data, std::size_t size)
+{
+	const char *bytes = static_cast<const char *>(data);
+	std::size_t words = size / 4;
+	std::uint64_t a = 0, b = 0;
+
+	for (std::size_t i = 0; i < words; i++)
+	{
+		std::uint32_t w;
+		std::memcpy(&w, bytes + i*4, 4);
+		a += w;
+		b += a;
+	}
+
+	return (b << 32) ^ a;
+}
+
+/**
+ * @brief Starts a new snapshot
+ * @param count Number of players that will be added
+ * @param show_max Number of shown players
+ * @param max_players Player limit
+ * @param generation Generation of the journal included in the snapshot
+ * @param next_id Id of the next new player
+ */
+void Snap_writer::begin(std::uint32_t count, int show_max,
+						unsigned max_players, std::uint32_t generation,
+						std::uint32_t next_id)
+{
+	Snap_header hdr{};
+	std::memcpy(hdr.magic, SNAP_MAGIC, sizeof(hdr.magic));
+	hdr.version = SNAP_VERSION;
+	hdr.name_size = PNAME_LIMIT;
+	hdr.count = count;
+	hdr.show_max = show_max;
+	hdr.max_players = max_players;
+	hdr.generation = generation;
+	hdr.next_id = next_id;
+
+	buf.clear();
+	buf.reserve(sizeof(hdr) + count * sizeof(Snap_record));
+	buf.insert(buf.end(), reinterpret_cast<char *>(&hdr),
+				reinterpret_cast<char *>(&hdr + 1));
+}
+
+/**
+ * @brief Appends a player, in the order of ranking
+ * @param name Player name
+ * @param score Player score
+ * @param id Player id
+ */
+void Snap_writer::add(std::string_view name, int score, std::uint32_t id)
+{
+	Snap_record rec{};
+	std::memcpy(rec.name, name.data(),
+				std::min<std::size_t>(name.size(), PNAME_LIMIT));
+	rec.score = score;
+	rec.id = id;
+
+	buf.insert(buf.end(), reinterpret_cast<char *>(&rec),
+				reinterpret_cast<char *>(&rec + 1));
+}
+
+/**
+ * @brief Writes the snapshot atomically, first to a temporary file,
+ *	which replaces the target file when it is complete
+ * @param path Path of the snapshot file
+ * @return True on success
+ */
+bool Snap_writer::write(const std::string &path)
+{
+	debug_info();
+
+	Snap_header *hdr = reinterpret_cast<Snap_header *>(buf.data());
+	hdr->checksum = snap_checksum(hdr + 1, buf.size() - sizeof(*hdr));
+
+	std::string tmp = path + ".tmp";
+	int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		report_err("Cannot open file " << tmp << ": " <<
+					std::strerror(errno), false);
+
+	const char *data = buf.data();
+	std::size_t left = buf.size();
+	while (left)
+	{
+		ssize_t n = ::write(fd, data, left);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0)
+		{
+			::close(fd);
+			::unlink(tmp.c_str());
+			report_err("Cannot write file " << tmp << ": " <<
+						std::strerror(errno), false);
+		}
+		data += n;
+		left -= n;
+	}
+
+	if (::fsync(fd) || ::close(fd) || ::rename(tmp.c_str(), path.c_str()))
+	{
+		::unlink(tmp.c_str());
+		report_err("Cannot save file " << path << ": " <<
+					std::strerror(errno), false);
+	}
+
+	return true;
+}
+
+/**
+ * @brief Maps a snapshot file and checks its header and checksum
+ * @param path Path of the snapshot file
+ * @return True if the file is a valid snapshot
+ */
+bool Snap_map::open(const std::string &path)
+{
+	debug_info();
+
+	close();
+
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		report_err("Cannot open file " << path << ": " <<
+					std::strerror(errno), false);
+
+	struct stat st;
+	if (::fstat(fd, &st) ||
+		static_cast<std::size_t>(st.st_size) < SNAP_HEADER_V1)
+	{
+		::close(fd);
+		report_err("File " << path << " is not a snapshot", false);
+	}
+
+	len = st.st_size;
+	addr = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (addr == MAP_FAILED)
+	{
+		addr = nullptr;
+		report_err("Cannot map file " << path << ": " <<
+					std::strerror(errno), false);
+	}
+
+	std::memcpy(&hdr, addr, SNAP_HEADER_V1);
+	if (std::memcmp(hdr.magic, SNAP_MAGIC, sizeof(hdr.magic)) ||
+		hdr.name_size != PNAME_LIMIT)
+	{
+		close();
+		report_err("File " << path << " is not a snapshot", false);
+	}
+
+	if (hdr.version == 1)
+	{
+		hdr_size = SNAP_HEADER_V1;
+		rec_size = SNAP_RECORD_V1;
+	}
+	else if (hdr.version == SNAP_VERSION && len >= sizeof(Snap_header))
+	{
+		std::memcpy(&hdr, addr, sizeof(Snap_header));
+		hdr_size = sizeof(Snap_header);
+		rec_size = sizeof(Snap_record);
+	}
+	else
+	{
+		std::uint16_t version = hdr.version;
+		close();
+		report_err("Unsupported snapshot version " << version, false);
+	}
+
+	const char *recs = static_cast<const char *>(addr) + hdr_size;
+	if (len != hdr_size + hdr.count * rec_size ||
+		snap_checksum(recs, len - hdr_size) != hdr.checksum)
+	{
+		close();
+		report_err("Snapshot " << path << " is corrupted", false);
+	}
+
+	return true;
+}
+
+/**
+ * @brief Unmaps the file
+ */
+void Snap_map::close()
+{
+	if (addr)
+		::munmap(addr, len);
+
+	addr = nullptr;
+	len = 0;
+	hdr = Snap_header{};
+	hdr_size = rec_size = 0;
+}
+
+/**
+ * @brief Checks whether a file starts as a snapshot
+ * @param path Path of the file
+ * @return True if the file has the snapshot magic
+ */
+bool Snap_map::is_snapshot(const std::string &path)
+{
+	char magic[sizeof(SNAP_MAGIC)] = {};
+	std::ifstream file(path, std::ios::binary);
+
+	file.read(magic, sizeof(magic));
+
+	return file && !std::memcmp(magic, SNAP_MAGIC, sizeof(magic));
+}
@@ -0,0 +1,107 @@
+/**
+ * @file snapshot.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Binary snapshot format of the scoreboard
+ *	Layout: header, then records of players in the order of their ranking.
+ *	All numbers are in the byte order of the host. Version 1 without ids
+ *	of the players is still read, its header and records are prefixes of
+ *	the current ones.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "scoreboard.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+const char SNAP_MAGIC[4] = {'S', 'C', 'B', 'S'};
+const std::uint16_t SNAP_VERSION = 2;
+const std::size_t SNAP_HEADER_V1 = 32;	///< Size of version 1 header
+const std::size_t SNAP_RECORD_V1 = 44;	///< Size of version 1 record
+
+/**
+ * @brief Header of the snapshot file
+ */
+struct Snap_header
+{
+	char magic[4];				///< SNAP_MAGIC
+	std::uint16_t version;		///< SNAP_VERSION
+	std::uint16_t name_size;	///< Size of name in record, PNAME_LIMIT
+	std::uint32_t count;		///< Number of records
+	std::int32_t show_max;		///< Number of shown players
+	std::uint32_t max_players;	///< Player limit
+	std::uint32_t generation;	///< Generation of the included journal
+	std::uint64_t checksum;		///< Checksum of the records
+	std::uint32_t next_id;		///< Id of the next new player
+	std::uint32_t reserved;		///< Zero
+};
+
+/**
+ * @brief Record of one player, name is padded with '\0'
+ */
+struct Snap_record
+{
+	char name[PNAME_LIMIT];		///< Name, without '\0' if 40 chars long
+	std::int32_t score;			///< Score
+	std::uint32_t id;			///< Player id, 0 in version 1
+};
+
+static_assert(sizeof(Snap_header) == SNAP_HEADER_V1 + 8,
+				"Unexpected snapshot header size");
+static_assert(sizeof(Snap_record) == SNAP_RECORD_V1 + 4,
+				"Unexpected snapshot record size");
+
+std::uint64_t snap_checksum(const void *data, std::size_t size);
+
+/**
+ * @brief Builds a snapshot in memory and writes it at once
+ */
+class Snap_writer
+{
+		std::vector<char> buf;		///< Whole file
+	public:
+		void begin(std::uint32_t count, int show_max, unsigned max_players,
+					std::uint32_t generation = 0, std::uint32_t next_id = 0);
+		void add(std::string_view name, int score, std::uint32_t id = 0);
+		bool write(const std::string &path);
+		std::size_t size() const { return buf.size(); }
+};
+
+/**
+ * @brief Snapshot file mapped to the memory, read only
+ */
+class Snap_map
+{
+		void *addr;				///< Start of the mapping
+		std::size_t len;		///< Length of the mapping
+		Snap_header hdr;		///< Header, fields missing in the file are 0
+		std::size_t hdr_size;	///< Size of the header in the file
+		std::size_t rec_size;	///< Size of a record in the file
+	public:
+		Snap_map(): addr{nullptr}, len{0}, hdr{}, hdr_size{0}, rec_size{0} {}
+		Snap_map(const Snap_map &) = delete;
+		Snap_map &operator=(const Snap_map &) = delete;
+
+		bool open(const std::string &path);
+		void close();
+
+		const Snap_header &header() const { return hdr; }
+		Snap_record record(std::uint32_t i) const
+		{
+			Snap_record rec{};
+			std::memcpy(&rec, static_cast<const char *>(addr) + hdr_size +
+						i * rec_size, rec_size);
+			return rec;
+		}
+
+		static bool is_snapshot(const std::string &path);
+
+		~Snap_map() { close(); }
+};
+
+#endif	// include SNAPSHOT_H
@@ -0,0 +1,124 @@
+/**
+ * @file stats.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the runtime statistics
+ */
+
+#include "stats.h"
+#include <algorithm>
+#include <iomanip>
+
+Scb_stats scb_stats;
+thread_local Stat_scope *Stat_scope::current = nullptr;
+
+const char *const phase_names[STAT_PHASES] =
+	{"parse", "lookup", "mutation", "rerank", "render", "journal"};
+
+const char *const counter_names[STAT_COUNTERS] =
+	{"rebuilds", "rows", "syncs", "ingested", "missed", "drains", "dropped",
+	"rejected", "tables", "snapshots"};
+
+
+/**
+ * @brief Records a sample
+ * @param ns Latency in nanoseconds
+ */
+void Histogram::add(std::uint64_t ns)
+{
+	unsigned b = ns ? 64 - __builtin_clzll(ns) : 0;
+	bump(buckets[b < HIST_BUCKETS ? b : HIST_BUCKETS - 1], 1);
+	bump(count, 1);
+	bump(sum, ns);
+	if (ns > get(max))
+		max.store(ns, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Removes all the samples
+ */
+void Histogram::reset()
+{
+	for (auto &b : buckets)
+		b.store(0, std::memory_order_relaxed);
+	count.store(0, std::memory_order_relaxed);
+	sum.store(0, std::memory_order_relaxed);
+	max.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Percentile, precise up to the bucket
+ * @param p Percentile, 0 .. 1
+ * @return Upper bound of the bucket with the percentile in ns
+ */
+std::uint64_t Histogram::percentile(double p) const
+{
+	std::uint64_t need = static_cast<std::uint64_t>(p * get(count) + 0.5);
+	std::uint64_t seen = 0;
+
+	for (unsigned b = 0; b < HIST_BUCKETS; b++)
+	{
+		seen += get(buckets[b]);
+		if (seen >= need && seen)
+			return b ? std::min<std::uint64_t>((1ull << b) - 1, get(max)) : 0;
+	}
+
+	return get(max);
+}
+
+/**
+ * @brief Prints the header of a table of histograms
+ * @param strm Output stream
+ * @param title Name of the first column
+ */
+void Histogram::print_head(std::ostream &strm, const char *title)
+{
+	strm << std::left << std::setw(12) << title << std::right
+		<< std::setw(10) << "COUNT" << std::setw(12) << "MEAN[ns]"
+		<< std::setw(12) << "P50<=[ns]" << std::setw(12) << "P99<=[ns]"
+		<< std::setw(12) << "MAX[ns]" << '\n';
+}
+
+/**
+ * @brief Prints the histogram as a row of a table
+ * @param strm Output stream
+ * @param name Name of the row
+ */
+void Histogram::print_row(std::ostream &strm, const char *name) const
+{
+	std::uint64_t cnt = get(count);
+
+	strm << std::left << std::setw(12) << name << std::right
+		<< std::setw(10) << cnt << std::setw(12) << (cnt ? get(sum) / cnt : 0)
+		<< std::setw(12) << percentile(0.5) << std::setw(12)
+		<< percentile(0.99) << std::setw(12) << get(max) << '\n';
+}
+
+/**
+ * @brief Resets all the statistics
+ */
+void Scb_stats::reset()
+{
+	for (auto &h : phases)
+		h.reset();
+	for (auto &c : counters)
+		c.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Prints the phases and counters
+ * @param strm Output stream
+ */
+void Scb_stats::print(std::ostream &strm) const
+{
+	Histogram::print_head(strm, "PHASE");
+	for (unsigned i = 0; i < STAT_PHASES; i++)
+		phases[i].print_row(strm, phase_names[i]);
+
+	strm << std::left << std::setw(12) << "COUNTER" << std::right
+		<< std::setw(10) << "VALUE" << '\n';
+	for (unsigned i = 0; i < STAT_COUNTERS; i++)
+		strm << std::left << std::setw(12) << counter_names[i] << std::right
+			<< std::setw(10) << counters[i].load(std::memory_order_relaxed)
+			<< '\n';
+}
@@ -0,0 +1,145 @@
+/**
+ * @file stats.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Runtime statistics of the scoreboard, latency histograms of the
+ *	commands and of the phases of their execution, and event counters
+ *	Histograms have power of two buckets in nanoseconds, recording a
+ *	sample is two reads of the clock and a few additions.
+ *	Statistics can be read by other threads while they are recorded, the
+ *	fields are atomic but updated without locked instructions, so samples
+ *	recorded by two threads at once may be lost, never torn.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+const unsigned HIST_BUCKETS = 40;	///< Bucket i holds [2^(i-1), 2^i) ns
+
+/**
+ * @brief Log-bucketed latency histogram
+ */
+class Histogram
+{
+		typedef std::atomic<std::uint64_t> Field;
+
+		Field buckets[HIST_BUCKETS];
+		Field count;				///< Number of samples
+		Field sum;					///< Sum of the samples in ns
+		Field max;					///< Longest sample in ns
+
+		static std::uint64_t get(const Field &f)
+		{
+			return f.load(std::memory_order_relaxed);
+		}
+		static void bump(Field &f, std::uint64_t num)
+		{
+			f.store(get(f) + num, std::memory_order_relaxed);
+		}
+	public:
+		Histogram() { reset(); }
+
+		void add(std::uint64_t ns);
+		void reset();
+		std::uint64_t samples() const { return get(count); }
+		std::uint64_t percentile(double p) const;
+		void print_row(std::ostream &strm, const char *name) const;
+		static void print_head(std::ostream &strm, const char *title);
+};
+
+/**
+ * @brief Phases of command execution, each sample is exclusive of the
+ *	nested phases, e.g. mutation does not contain its re-ranking
+ */
+enum Stat_phase
+{
+	STAT_PARSE,			///< Splitting and recognizing the command
+	STAT_LOOKUP,		///< Finding a player by name or rank
+	STAT_MUTATION,		///< Changing the player map
+	STAT_RERANK,		///< Updating or rebuilding the ranking
+	STAT_RENDER,		///< Rendering and writing the table
+	STAT_JOURNAL,		///< Appending a record to the journal
+	STAT_PHASES
+};
+
+/**
+ * @brief Event counters
+ */
+enum Stat_counter
+{
+	STAT_REBUILDS,		///< Full rebuilds of the ranking, sort_scb
+	STAT_ROWS,			///< Rendered rows of the table
+	STAT_SYNCS,			///< Synchronizations of the journal to the disk
+	STAT_INGESTED,		///< Queued score events applied to the players
+	STAT_MISSED,		///< Queued score events of no existing player
+	STAT_DRAINS,		///< Batches of queued events applied at once
+	STAT_DROPPED,		///< Events dropped, the queue was full
+	STAT_REJECTED,		///< Events rejected, the queue was full
+	STAT_TABLES,		///< Tables written to the table file
+	STAT_SNAPSHOTS,		///< Snapshots written by child processes
+	STAT_COUNTERS
+};
+
+/**
+ * @brief Statistics of phases and counters of the whole program
+ */
+class Scb_stats
+{
+		Histogram phases[STAT_PHASES];
+		std::atomic<std::uint64_t> counters[STAT_COUNTERS];
+	public:
+		Scb_stats() { reset(); }
+
+		void add(Stat_phase phase, std::uint64_t ns)
+		{
+			phases[phase].add(ns);
+		}
+		void count(Stat_counter cnt, std::uint64_t num = 1)
+		{
+			counters[cnt].fetch_add(num, std::memory_order_relaxed);
+		}
+		void reset();
+		void print(std::ostream &strm) const;
+};
+
+extern Scb_stats scb_stats;
+
+/**
+ * @brief Measures the scope as a phase, time of the nested scopes is
+ *	subtracted, so the phases do not overlap
+ */
+class Stat_scope
+{
+		typedef std::chrono::steady_clock Clock;
+
+		Stat_phase phase;
+		Clock::time_point start;
+		std::uint64_t nested;			///< Time of the nested scopes
+		Stat_scope *outer;				///< Enclosing scope
+		static thread_local Stat_scope *current;
+	public:
+		explicit Stat_scope(Stat_phase ph): phase{ph}, start{Clock::now()},
+									nested{0}, outer{current}
+		{
+			current = this;
+		}
+		Stat_scope(const Stat_scope &) = delete;
+		Stat_scope &operator=(const Stat_scope &) = delete;
+
+		~Stat_scope()
+		{
+			std::uint64_t ns = std::chrono::duration_cast<
+				std::chrono::nanoseconds>(Clock::now() - start).count();
+			current = outer;
+			if (outer)
+				outer->nested += ns;
+			scb_stats.add(phase, ns - nested);
+		}
+};
+
+#endif	// include STATS_H
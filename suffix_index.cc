@@ -0,0 +1,145 @@
+/**
+ * @file suffix_index.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the index of player name suffixes
+ */
+
+#include "suffix_index.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <functional>
+
+
+/**
+ * @brief Takes the lowest free suffix number of a base name
+ * @param base Base name, without suffix
+ * @return Suffix number, the caller has to check that the name is not
+ *	taken by a player created with the full "base(N)" name
+ */
+unsigned Suffix_index::take(std::string_view base)
+{
+	auto it = pools.find(base);
+	if (it == pools.end())
+	{
+		bases.emplace_back(base);
+		it = pools.emplace(bases.back(), Pool()).first;
+	}
+
+	Pool &pool = it->second;
+	if (pool.freed.empty())
+		return pool.next++;
+
+	std::pop_heap(pool.freed.begin(), pool.freed.end(),
+					std::greater<unsigned>());
+	unsigned num = pool.freed.back();
+	pool.freed.pop_back();
+
+	return num;
+}
+
+/**
+ * @brief Frees the suffix number of a name which is no longer used
+ * @param name Full name of a removed or renamed player, "base(N)"
+ */
+void Suffix_index::release(std::string_view name)
+{
+	unsigned num;
+	std::string_view base = split(name, num);
+	if (!num)
+		return;
+
+	auto it = pools.find(base);
+	if (it == pools.end() || num >= it->second.next)
+		return;		// number not given out by the index
+
+	it->second.freed.push_back(num);
+	std::push_heap(it->second.freed.begin(), it->second.freed.end(),
+					std::greater<unsigned>());
+}
+
+/**
+ * @brief Takes back the suffix number of a released name, when its player
+ *	is restored by undo or by an aborted batch
+ * @param name Full name of the restored player, "base(N)"
+ */
+void Suffix_index::claim(std::string_view name)
+{
+	unsigned num;
+	std::string_view base = split(name, num);
+	if (!num)
+		return;
+
+	auto it = pools.find(base);
+	if (it == pools.end())
+		return;
+
+	// a number not given out by the index was not released either
+	std::vector<unsigned> &freed = it->second.freed;
+	auto at = std::find(freed.begin(), freed.end(), num);
+	if (at == freed.end())
+		return;
+
+	*at = freed.back();
+	freed.pop_back();
+	std::make_heap(freed.begin(), freed.end(), std::greater<unsigned>());
+}
+
+/**
+ * @brief Splits a name to its base and its suffix number
+ * @param name Full name, "base(N)" or a name without a suffix
+ * @param num Output, the suffix number, 0 if the name has no suffix
+ * @return Base name, the whole name if it has no suffix
+ */
+std::string_view Suffix_index::split(std::string_view name, unsigned &num)
+{
+	num = 0;
+
+	// only names ending with "(N)" can have a suffix
+	if (name.size() < 4 || name.back() != ')')
+		return name;
+
+	std::size_t open = name.rfind('(');
+	if (open == std::string_view::npos || open == 0)
+		return name;
+
+	const char *first = name.data() + open + 1;
+	const char *last = name.data() + name.size() - 1;
+	auto res = std::from_chars(first, last, num);
+	if (res.ec != std::errc() || res.ptr != last || num == 0)
+	{
+		num = 0;
+		return name;
+	}
+
+	return name.substr(0, open);
+}
+
+/**
+ * @brief Forgets all the base names
+ */
+void Suffix_index::clear()
+{
+	pools.clear();
+	bases.clear();
+}
+
+/**
+ * @brief Formats the full name "base(N)" without allocating
+ * @param buf Output buffer, at least base length + 13 characters
+ * @param base Base name
+ * @param num Suffix number
+ * @return Length of the full name
+ */
+unsigned Suffix_index::format(char *buf, std::string_view base, unsigned num)
+{
+	std::memcpy(buf, base.data(), base.size());
+	char *end = buf + base.size();
+
+	*end++ = '(';
+	end = std::to_chars(end, end + 10, num).ptr;
+	*end++ = ')';
+
+	return end - buf;
+}
@@ -0,0 +1,49 @@
+/**
+ * @file suffix_index.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Index of the "(N)" suffixes used to make player names unique
+ */
+
+#ifndef SUFFIX_INDEX_H
+#define SUFFIX_INDEX_H
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+
+/**
+ * @brief Remembers for every base name the next free suffix number and
+ *	the numbers freed by removed or renamed players
+ *	Every number below the next free one is either used by a player
+ *	"base(N)", or is in the freed numbers, so the lowest free number is
+ *	always found without probing the player map.
+ */
+class Suffix_index
+{
+		/**
+		 * @brief Suffix numbers of one base name
+		 */
+		struct Pool
+		{
+			unsigned next = 1;				///< Never used number
+			std::vector<unsigned> freed;	///< Min-heap of freed numbers
+		};
+
+		std::deque<std::string> bases;	///< Storage of the base names
+		///< base name -> its suffix numbers, keys point to bases
+		std::unordered_map<std::string_view, Pool> pools;
+	public:
+		unsigned take(std::string_view base);
+		void release(std::string_view name);
+		void claim(std::string_view name);
+		void clear();
+
+		static unsigned format(char *buf, std::string_view base,
+								unsigned num);
+		static std::string_view split(std::string_view name, unsigned &num);
+};
+
+#endif	// include SUFFIX_INDEX_H
@@ -0,0 +1,161 @@
+/**
+ * @file table_writer.cc
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Definitions of the writer of the table file
+ */
+
+#include "table_writer.h"
+#include "scoreboard.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+/**
+ * @brief Starts the writer, the current table is written right away
+ * @param file Path of the table file
+ * @return True on success
+ */
+bool Table_writer::start(const std::string &file)
+{
+	debug_info();
+
+	if (running())
+		report_err("Table file already set", false);
+
+	path = file;
+	tmp = file + ".tmp";
+	written = ~static_cast<std::uint64_t>(0);
+	changed = false;
+	stopping = false;
+	writer = std::thread(&Table_writer::run, this);
+	return true;
+}
+
+/**
+ * @brief Stops the writer, the last state of the board is written first
+ */
+void Table_writer::stop()
+{
+	if (!running())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(wake_m);
+		stopping = true;
+	}
+	wake.notify_one();
+	writer.join();
+}
+
+/**
+ * @brief Tells the writer the board changed, does not wait for it
+ */
+void Table_writer::notify()
+{
+	{
+		std::lock_guard<std::mutex> lock(wake_m);
+		changed = true;
+	}
+	wake.notify_one();
+}
+
+/**
+ * @brief Writer thread, writes the table after a change, writes are at
+ *	least TABLE_GAP apart, so a burst of changes is written once, a view
+ *	behind the board, of a batch in progress, is taken again later
+ */
+void Table_writer::run()
+{
+	std::unique_lock<std::mutex> lock(wake_m);
+	for (;;)
+	{
+		// board does not change after stop, the last write has its state
+		bool last = stopping;
+		lock.unlock();
+		std::uint64_t before = written;
+		bool fresh = publish();
+		if (last)
+			return;
+
+		if (written != before || !fresh)
+			std::this_thread::sleep_for(TABLE_GAP);
+		lock.lock();
+
+		if (fresh)
+			wake.wait_for(lock, TABLE_POLL,
+							[this] { return changed || stopping; });
+		changed = false;
+	}
+}
+
+/**
+ * @brief Writes the table if the board changed since the last write
+ * @return True if the file has the current version of the board
+ */
+bool Table_writer::publish()
+{
+	std::uint64_t current = scb.get_version();
+	if (current == written)
+		return true;
+
+	// a failed write is not repeated until the next change, a view can be
+	// published before its version is
+	std::shared_ptr<const Board_view> view = scb.view();
+	if (view->version != written)
+	{
+		write(*view);
+		written = view->version;
+	}
+
+	return view->version >= current;
+}
+
+/**
+ * @brief Renders a view and replaces the table file with it
+ * @param view View of the board
+ * @return True on success
+ */
+bool Table_writer::write(const Board_view &view)
+{
+	debug_info();
+
+	view.render(render);
+
+	// not synchronized to the disk, readers need a whole file, not a
+	// durable one
+	int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		report_err("Cannot open file " << tmp << ": " <<
+					std::strerror(errno), false);
+
+	const char *data = render.data();
+	std::size_t left = render.size();
+	while (left)
+	{
+		ssize_t n = ::write(fd, data, left);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0)
+		{
+			::close(fd);
+			::unlink(tmp.c_str());
+			report_err("Cannot write file " << tmp << ": " <<
+						std::strerror(errno), false);
+		}
+		data += n;
+		left -= n;
+	}
+
+	if (::close(fd) || ::rename(tmp.c_str(), path.c_str()))
+	{
+		::unlink(tmp.c_str());
+		report_err("Cannot write table file " << path << ": " <<
+					std::strerror(errno), false);
+	}
+
+	scb_stats.count(STAT_TABLES);
+	return true;
+}
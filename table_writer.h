@@ -0,0 +1,68 @@
+/**
+ * @file table_writer.h
+ * @date 17.10.2026
+ * @author Kentril Despair
+ * @brief Writer of the score table to a file, for programs showing it,
+ *	e.g. overlays of streams. A thread of its own takes views of the board
+ *	(see board_view.h), renders them and writes the file, so the commands
+ *	never wait for the disk. Changes are only signalled, a burst of them
+ *	is written once per TABLE_GAP, with the latest state. The table is
+ *	written to a temporary file, which is renamed over the table file, so
+ *	a reader always sees a whole table.
+ */
+
+#ifndef TABLE_WRITER_H
+#define TABLE_WRITER_H
+
+#include "render.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class Scoreboard;
+class Board_view;
+
+///< Longest wait of the writer, changes of other threads are not signalled
+const std::chrono::milliseconds TABLE_POLL{100};
+///< Shortest time between two writes, a burst of changes is written once
+const std::chrono::milliseconds TABLE_GAP{10};
+
+/**
+ * @brief Table file with its writer thread
+ */
+class Table_writer
+{
+		Scoreboard &scb;
+		std::string path;				///< Table file
+		std::string tmp;				///< Written first, then renamed
+		Table_render render;			///< Used only by the writer
+		std::thread writer;
+		std::uint64_t written;			///< Version of the board in the file
+
+		std::mutex wake_m;				///< Guards changed and stopping
+		std::condition_variable wake;	///< Wakes the waiting writer
+		bool changed;					///< Board changed since the wakeup
+		bool stopping;					///< Writer has to end
+	public:
+		explicit Table_writer(Scoreboard &board): scb{board}, written{0},
+													changed{false},
+													stopping{false} {}
+		Table_writer(const Table_writer &) = delete;
+		Table_writer &operator=(const Table_writer &) = delete;
+
+		bool start(const std::string &file);
+		void stop();
+		bool running() const { return writer.joinable(); }
+		void notify();
+
+		~Table_writer() { stop(); }
+	private:
+		void run();
+		bool publish();
+		bool write(const Board_view &view);
+};
+
+#endif	// include TABLE_WRITER_H